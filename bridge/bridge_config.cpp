@@ -0,0 +1,269 @@
+#include "bridge_config.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static std::string trim(const std::string &text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+static bool parse_int(const std::string &text, long min, long max, long &out) {
+    char *end = nullptr;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || value < min || value > max) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+static bool parse_seconds(const std::string &text, double min, double max, double &out) {
+    char *end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !(value >= min && value <= max)) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+static bool parse_bool(const std::string &text, bool &out) {
+    if (text == "true" || text == "yes" || text == "on" || text == "1") {
+        out = true;
+        return true;
+    }
+    if (text == "false" || text == "no" || text == "off" || text == "0") {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+// Low-latency keys shared by [input] and [output].
+static bool is_tuning_key(const std::string &key) {
+    return key == "cpu" || key == "realtime_priority" || key == "busy_poll" || key == "socket_buffer" || key == "spin";
+}
+
+static bool parse_tuning(const std::string &key, const std::string &value, gacn::LatencyTuning &tuning) {
+    long number = 0;
+    bool ok = false;
+    if (key == "cpu") {
+        ok = parse_int(value, -1, 1023, number);
+        tuning.cpu = (int)number;
+    } else if (key == "realtime_priority") {
+        ok = parse_int(value, 0, 99, number);
+        tuning.realtime_priority = (int)number;
+    } else if (key == "busy_poll") {
+        ok = parse_int(value, 0, 1000000, number);
+        tuning.busy_poll_us = (int)number;
+    } else if (key == "socket_buffer") {
+        ok = parse_int(value, 0, 1 << 30, number);
+        tuning.socket_buffer = (int)number;
+    } else if (key == "spin") {
+        ok = parse_int(value, 0, 1000000, number);
+        tuning.spin_us = (int)number;
+    }
+    return ok;
+}
+
+// Parses "a" or "a-b" into an inclusive universe range.
+static bool parse_range(const std::string &text, long &first, long &last) {
+    size_t dash = text.find('-');
+    if (dash == std::string::npos) {
+        if (!parse_int(trim(text), 1, 63999, first)) {
+            return false;
+        }
+        last = first;
+        return true;
+    }
+    return parse_int(trim(text.substr(0, dash)), 1, 63999, first) &&
+            parse_int(trim(text.substr(dash + 1)), first, 63999, last);
+}
+
+bool parse_universe_list(const std::string &text, std::vector<uint16_t> &out) {
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        long first, last;
+        if (!parse_range(item, first, last)) {
+            return false;
+        }
+        for (long u = first; u <= last; ++u) {
+            out.push_back((uint16_t)u);
+        }
+    }
+    return true;
+}
+
+void parse_interface_list(const std::string &text, std::vector<std::string> &out) {
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item = trim(item);
+        if (!item.empty()) {
+            out.push_back(item);
+        }
+    }
+}
+
+// Parses "interface: universes".
+static bool parse_binding(const std::string &text, BridgeConfig::Binding &out) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    out.interface = trim(text.substr(0, colon));
+    out.index = 0;
+    return !out.interface.empty() && parse_universe_list(text.substr(colon + 1), out.universes);
+}
+
+// Points every binding at its interface in the list.
+static bool resolve_bindings(std::vector<BridgeConfig::Binding> &bindings, const std::vector<std::string> &interfaces,
+        const char *section, std::string &error) {
+    for (BridgeConfig::Binding &binding : bindings) {
+        binding.index = -1;
+        for (size_t i = 0; i < interfaces.size(); ++i) {
+            if (interfaces[i] == binding.interface) {
+                binding.index = (int)i;
+            }
+        }
+        if (binding.index < 0) {
+            error = std::string("[") + section + "] binds universes to '" + binding.interface + "', which is not in its interfaces";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BridgeConfig::load(const char *path, std::string &error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = std::string("cannot open ") + path;
+        return false;
+    }
+
+    std::string section;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+        if (line.front() == '[' && line.back() == ']') {
+            section = trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = "line " + std::to_string(line_number) + ": expected key = value";
+            return false;
+        }
+        const std::string key = trim(line.substr(0, equals));
+        const std::string value = trim(line.substr(equals + 1));
+        long number = 0;
+        bool ok = true;
+
+        if (section == "general" && key == "stats_interval") {
+            ok = parse_int(value, 0, 86400, number);
+            stats_interval = (int)number;
+        } else if (section == "input" && key == "port") {
+            ok = parse_int(value, 1, 65535, number);
+            input_port = (uint16_t)number;
+        } else if (section == "input" && key == "universes") {
+            ok = parse_universe_list(value, universes);
+        } else if (section == "input" && key == "merge") {
+            ok = value == "latest" || value == "htp";
+            merge = value == "htp" ? gacn::MERGE_HTP : gacn::MERGE_LATEST;
+        } else if (section == "input" && key == "max_sockets") {
+            ok = parse_int(value, 1, 1024, number);
+            max_sockets = (int)number;
+        } else if ((section == "input" || section == "output") && key == "interfaces") {
+            parse_interface_list(value, section == "input" ? input_interfaces : output_interfaces);
+        } else if ((section == "input" || section == "output") && key == "bind") {
+            Binding binding;
+            ok = parse_binding(value, binding);
+            (section == "input" ? input_bindings : output_bindings).push_back(binding);
+        } else if ((section == "input" || section == "output") && is_tuning_key(key)) {
+            ok = parse_tuning(key, value, section == "input" ? input_tuning : output_tuning);
+        } else if (section == "input" && key == "loss") {
+            ok = value == "hold" || value == "blackout" || value == "fade";
+            loss = value == "fade" ? gacn::LOSS_FADE : (value == "blackout" ? gacn::LOSS_BLACKOUT : gacn::LOSS_HOLD);
+        } else if (section == "input" && key == "fade_time") {
+            ok = parse_seconds(value, 0.0, 3600.0, fade_time);
+        } else if (section == "input" && key == "source_timeout") {
+            ok = parse_seconds(value, 0.1, 3600.0, source_timeout);
+        } else if (section == "input" && key == "local") {
+            ok = parse_bool(value, input_local);
+        } else if (section == "output" && key == "mode") {
+            ok = value == "none" || value == "multicast" || value == "unicast";
+            output_mode = value == "none" ? OUTPUT_NONE : (value == "unicast" ? OUTPUT_UNICAST : OUTPUT_MULTICAST);
+        } else if (section == "output" && key == "destination") {
+            destination = value;
+        } else if (section == "output" && key == "port") {
+            ok = parse_int(value, 1, 65535, number);
+            output_port = (uint16_t)number;
+        } else if (section == "output" && key == "priority") {
+            ok = parse_int(value, 0, 200, number);
+            priority = (uint8_t)number;
+        } else if (section == "output" && key == "source_name") {
+            source_name = value;
+        } else if (section == "output" && key == "queue") {
+            ok = parse_int(value, 16, 1 << 20, number);
+            queue_capacity = (int)number;
+        } else if (section == "output" && key == "congestion") {
+            ok = value == "coalesce" || value == "drop_oldest" || value == "block";
+            congestion = value == "block" ? gacn::CONGESTION_BLOCK : (value == "drop_oldest" ? gacn::CONGESTION_DROP_OLDEST : gacn::CONGESTION_COALESCE);
+        } else if (section == "output" && key == "backlog") {
+            ok = parse_int(value, 0, 65536, number);
+            backlog = (int)number;
+        } else if (section == "output" && key == "universe_backlog") {
+            ok = parse_int(value, 1, 256, number);
+            universe_backlog = (int)number;
+        } else if (section == "output" && key == "block_timeout") {
+            ok = parse_int(value, 0, 1000000, number);
+            block_timeout_us = (int)number;
+        } else if (section == "output" && key == "workers") {
+            ok = parse_int(value, 1, gacn::SenderEngine::MAX_WORKERS, number);
+            output_workers = (int)number;
+        } else if (section == "output" && key == "local") {
+            ok = parse_bool(value, output_local);
+        } else if (section == "remap") {
+            // "first[-last] = target" moves a block of universes.
+            long first, last, target;
+            ok = parse_range(key, first, last) && parse_int(value, 1, 63999, target) && target + (last - first) <= 63999;
+            if (ok) {
+                remaps.push_back({ (uint16_t)first, (uint16_t)(last - first + 1), (uint16_t)target });
+            }
+        } else if (section == "record" && key == "path") {
+            record_path = value;
+        } else {
+            error = "line " + std::to_string(line_number) + ": unknown setting '" + key + "' in [" + section + "]";
+            return false;
+        }
+
+        if (!ok) {
+            error = "line " + std::to_string(line_number) + ": invalid value for '" + key + "': " + value;
+            return false;
+        }
+    }
+
+    if (universes.empty()) {
+        error = "[input] universes is required";
+        return false;
+    }
+    return resolve_bindings(input_bindings, input_interfaces, "input", error) &&
+            resolve_bindings(output_bindings, output_interfaces, "output", error);
+}
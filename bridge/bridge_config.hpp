@@ -0,0 +1,84 @@
+#ifndef BRIDGE_CONFIG_HPP
+#define BRIDGE_CONFIG_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "receiver_engine.hpp"
+#include "sender_engine.hpp"
+#include "thread_tuning.hpp"
+#include "universe_merger.hpp"
+
+// Settings for the headless gacn-bridge daemon, read from an INI-style file.
+// See gacn-bridge.conf.example for the format.
+struct BridgeConfig {
+    enum OutputMode {
+        OUTPUT_NONE,
+        OUTPUT_MULTICAST,
+        OUTPUT_UNICAST,
+    };
+
+    struct Remap {
+        uint16_t first;
+        uint16_t count;
+        uint16_t target;
+    };
+
+    // "bind = eth2: 100-199" puts universes on one of the section's
+    // interfaces instead of the first.
+    struct Binding {
+        std::string interface;
+        int index; // into the section's interfaces, set once the file is read
+        std::vector<uint16_t> universes;
+    };
+
+    // [general]
+    int stats_interval = 10;
+
+    // [input]
+    uint16_t input_port = 5568;
+    std::vector<uint16_t> universes;
+    gacn::MergeMode merge = gacn::MERGE_LATEST;
+    int max_sockets = 64;
+    std::vector<std::string> input_interfaces;
+    std::vector<Binding> input_bindings;
+    gacn::LatencyTuning input_tuning;
+    gacn::LossPolicy loss = gacn::LOSS_HOLD;
+    double fade_time = 1.0;
+    double source_timeout = 2.5;
+    bool input_local = false;
+
+    // [output]
+    OutputMode output_mode = OUTPUT_MULTICAST;
+    std::string destination = "127.0.0.1";
+    uint16_t output_port = 5568;
+    uint8_t priority = 100;
+    std::string source_name = "gacn bridge";
+    std::vector<std::string> output_interfaces;
+    std::vector<Binding> output_bindings; // output (remapped) universe numbers
+    gacn::LatencyTuning output_tuning; // cpu is that of worker 0
+    int queue_capacity = 4096;
+    gacn::CongestionPolicy congestion = gacn::CONGESTION_COALESCE;
+    int backlog = gacn::SenderEngine::DEFAULT_BACKLOG;
+    int universe_backlog = gacn::SenderEngine::DEFAULT_UNIVERSE_BACKLOG;
+    int block_timeout_us = gacn::SenderEngine::DEFAULT_BLOCK_TIMEOUT_US;
+    int output_workers = 1;
+    bool output_local = false;
+
+    // [remap]
+    std::vector<Remap> remaps;
+
+    // [record]
+    std::string record_path;
+
+    bool load(const char *path, std::string &error);
+};
+
+// Parses "eth1, eth2" into interface names, indices or addresses.
+void parse_interface_list(const std::string &text, std::vector<std::string> &out);
+
+// Parses "1-16, 100, 200-210" into a list of universes.
+bool parse_universe_list(const std::string &text, std::vector<uint16_t> &out);
+
+#endif
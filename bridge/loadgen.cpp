@@ -0,0 +1,225 @@
+// Synthetic load test over loopback: a LoadGenerator sends to 127.0.0.1 (or
+// multicast) and a ReceiverEngine with a LoadAnalyzer on its packet tap
+// measures throughput, loss, out-of-order detection and latency.
+
+#include "loadgen.hpp"
+
+#include "e131.h"
+#include "load_engine.hpp"
+#include "receiver_engine.hpp"
+#include "sacn_log.hpp"
+#include "thread_tuning.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+static std::atomic<bool> quit{ false };
+
+static void handle_signal(int) {
+    quit = true;
+}
+
+static void print_usage() {
+    std::fprintf(stderr,
+            "usage: gacn-bridge --loadgen [options]\n"
+            "  --universes N     universes to send (default 16)\n"
+            "  --first U         first universe (default 1)\n"
+            "  --rate HZ         frames per second per universe (default 44)\n"
+            "  --slots N         slots per universe, 16-512 (default 512)\n"
+            "  --sources N       duplicate sources, each with its own CID (default 1)\n"
+            "  --workers N       sender threads per source (default 1)\n"
+            "  --loss P          drop probability per packet (default 0)\n"
+            "  --reorder P       probability a packet is sent late (default 0)\n"
+            "  --seed N          impairment seed (default 1)\n"
+            "  --seconds S       run time, 0 = until interrupted (default 10)\n"
+            "  --port P          UDP port (default 5569)\n"
+            "  --multicast       send to the multicast groups instead of 127.0.0.1\n"
+            "low-latency options, for both the generator and the receiver:\n"
+            "  --realtime P      SCHED_FIFO priority 1-99\n"
+            "  --busy-poll US    SO_BUSY_POLL on every socket\n"
+            "  --socket-buffer N SO_RCVBUF / SO_SNDBUF in bytes\n"
+            "  --spin US         poll this long before sleeping\n");
+}
+
+static void print_denied(const char *who, uint32_t denied) {
+    if (denied == 0) {
+        return;
+    }
+    std::printf("%s: OS refused", who);
+    for (uint32_t bit = 1; bit <= gacn::TUNING_SOCKET_BUFFER; bit <<= 1) {
+        if (denied & bit) {
+            std::printf(" %s", gacn::tuning_option_name((gacn::TuningOption)bit));
+        }
+    }
+    std::printf("\n");
+}
+
+static double to_us(uint64_t ns) {
+    return (double)ns / 1000.0;
+}
+
+static void print_report(const gacn::LoadGenerator::Report &tx, const gacn::LoadAnalyzer::Report &rx, bool final) {
+    if (!final) {
+        gacn::log_info("loadgen: tx %llu, rx %.0f pkt/s, lost %llu, late %llu, detection %.4f, latency p50 %.0f us p99 %.0f us",
+                (unsigned long long)tx.sent, rx.packet_rate, (unsigned long long)rx.lost, (unsigned long long)rx.late,
+                rx.detection_accuracy, to_us(rx.latency_p50), to_us(rx.latency_p99));
+        return;
+    }
+    std::printf("generator: %.2f s, %llu ticks (%llu late), %llu submitted, %llu queue drops, %llu sent\n",
+            tx.elapsed, (unsigned long long)tx.ticks, (unsigned long long)tx.late_ticks,
+            (unsigned long long)tx.submitted, (unsigned long long)tx.queue_drops, (unsigned long long)tx.sent);
+    std::printf("impairment: %llu dropped, %llu reordered\n",
+            (unsigned long long)tx.impaired_lost, (unsigned long long)tx.impaired_reordered);
+    std::printf("receiver: %llu packets in %.2f s, %.0f pkt/s, %.2f MB/s of slot data\n",
+            (unsigned long long)rx.packets, rx.elapsed, rx.packet_rate,
+            rx.elapsed > 0.0 ? (double)rx.bytes / rx.elapsed / 1e6 : 0.0);
+    std::printf("loss: %llu lost (%.4f%%), %llu late, %llu duplicates, %llu corrupt, %llu foreign\n",
+            (unsigned long long)rx.lost, rx.loss_ratio * 100.0, (unsigned long long)rx.late,
+            (unsigned long long)rx.duplicates, (unsigned long long)rx.corrupt, (unsigned long long)rx.foreign);
+    std::printf("out of order detection: %llu detected, %llu missed, %llu false alarms, accuracy %.6f\n",
+            (unsigned long long)rx.detected, (unsigned long long)rx.missed,
+            (unsigned long long)rx.false_alarms, rx.detection_accuracy);
+    std::printf("latency us: min %.1f p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f\n",
+            to_us(rx.latency_min), to_us(rx.latency_p50), to_us(rx.latency_p90),
+            to_us(rx.latency_p99), to_us(rx.latency_p999), to_us(rx.latency_max));
+
+    // Compact histogram: one line per power of two that saw any packets.
+    for (int base = 0; base < gacn::LoadAnalyzer::LATENCY_BUCKETS; base += 8) {
+        uint64_t count = 0;
+        for (int i = base; i < base + 8; ++i) {
+            count += rx.latency_histogram[i];
+        }
+        if (count == 0) {
+            continue;
+        }
+        std::printf("  <= %10.1f us  %10llu  %5.1f%%\n", to_us(gacn::LoadAnalyzer::latency_bucket_limit(base + 7)),
+                (unsigned long long)count, rx.packets > 0 ? 100.0 * (double)count / (double)rx.packets : 0.0);
+    }
+}
+
+int run_loadgen(int argc, char **argv) {
+    gacn::LoadGenerator::Config config;
+    config.target.port = 5569;
+    config.target.multicast = false;
+    double seconds = 10.0;
+    // Parsed wide, a uint16_t would wrap 65537 round to universe 1.
+    long first_universe = config.first_universe;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--help") {
+            print_usage();
+            return 0;
+        }
+        if (option == "--multicast") {
+            config.target.multicast = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage();
+            return 2;
+        }
+        const char *value = argv[++i];
+        if (option == "--universes") {
+            config.universe_count = std::atoi(value);
+        } else if (option == "--first") {
+            first_universe = std::strtol(value, nullptr, 10);
+        } else if (option == "--rate") {
+            config.rate_hz = std::atof(value);
+        } else if (option == "--slots") {
+            config.slots = (uint16_t)std::atoi(value);
+        } else if (option == "--sources") {
+            config.sources = std::atoi(value);
+        } else if (option == "--workers") {
+            config.worker_count = std::atoi(value);
+        } else if (option == "--loss") {
+            config.impairment.loss = std::atof(value);
+        } else if (option == "--reorder") {
+            config.impairment.reorder = std::atof(value);
+        } else if (option == "--seed") {
+            config.impairment.seed = std::strtoull(value, nullptr, 10);
+        } else if (option == "--seconds") {
+            seconds = std::atof(value);
+        } else if (option == "--port") {
+            config.target.port = (uint16_t)std::atoi(value);
+        } else if (option == "--realtime") {
+            config.tuning.realtime_priority = std::atoi(value);
+        } else if (option == "--busy-poll") {
+            config.tuning.busy_poll_us = std::atoi(value);
+        } else if (option == "--socket-buffer") {
+            config.tuning.socket_buffer = std::atoi(value);
+        } else if (option == "--spin") {
+            config.tuning.spin_us = std::atoi(value);
+        } else {
+            print_usage();
+            return 2;
+        }
+    }
+    if (first_universe < 1 || first_universe > 63999 || config.universe_count < 1
+            || first_universe + config.universe_count - 1 > 63999) {
+        std::fprintf(stderr, "universes must lie within 1-63999\n");
+        print_usage();
+        return 2;
+    }
+    config.first_universe = (uint16_t)first_universe;
+    if (!config.target.multicast) {
+        e131_addr_t loopback;
+        e131_unicast_dest(&loopback, "127.0.0.1", config.target.port);
+        config.target.unicast_addr = loopback.sin_addr.s_addr;
+    }
+
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    gacn::LoadAnalyzer analyzer;
+    analyzer.configure(config.first_universe, config.universe_count, config.sources);
+
+    gacn::ReceiverEngine receiver(config.target.port);
+    receiver.set_latency_tuning(config.tuning);
+    analyzer.attach(receiver);
+    if (!receiver.start()) {
+        return 1;
+    }
+    for (int i = 0; i < config.universe_count; ++i) {
+        if (!receiver.get_memberships().join((uint16_t)(config.first_universe + i))) {
+            receiver.stop();
+            return 1;
+        }
+    }
+
+    gacn::LoadGenerator generator;
+    if (!generator.start(config)) {
+        receiver.stop();
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    while (!quit.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto now = std::chrono::steady_clock::now();
+        if (seconds > 0.0 && std::chrono::duration<double>(now - start).count() >= seconds) {
+            break;
+        }
+        if (now - last_report >= std::chrono::seconds(1)) {
+            print_report(generator.get_report(), analyzer.get_report(), false);
+            last_report = now;
+        }
+    }
+
+    generator.stop();
+    // Let the last packets and held-back reorders arrive.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const uint32_t receiver_denied = receiver.get_denied_tuning();
+    receiver.stop();
+    print_report(generator.get_report(), analyzer.get_report(), true);
+    print_denied("receiver tuning", receiver_denied);
+    print_denied("generator tuning", generator.get_denied_tuning());
+    return 0;
+}
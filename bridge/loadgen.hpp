@@ -0,0 +1,8 @@
+#ifndef LOADGEN_HPP
+#define LOADGEN_HPP
+
+// `gacn-bridge --loadgen [options]`: pushes generated traffic at a receiver
+// on this machine and prints what it sustained. argv[0] is "--loadgen".
+int run_loadgen(int argc, char **argv);
+
+#endif
@@ -0,0 +1,187 @@
+// gacn-bridge: headless sACN merger / relay / remapper / recorder built from
+// the same engine code as the Godot extension.
+//
+//     gacn-bridge <config file>
+//     gacn-bridge --loadgen [options]
+//     gacn-bridge --pcap <capture> [options]
+
+#include "bridge_config.hpp"
+#include "loadgen.hpp"
+#include "replay.hpp"
+
+#include "e131.h"
+#include "pcap_file.hpp"
+#include "receiver_engine.hpp"
+#include "sacn_log.hpp"
+#include "sender_engine.hpp"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static std::atomic<bool> quit{ false };
+
+static void handle_signal(int) {
+    quit = true;
+}
+
+static void print_usage(const char *program) {
+    std::fprintf(stderr, "usage: %s <config file>\n       %s --loadgen [options]\n       %s --pcap <capture> [options]\n", program, program, program);
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && std::strcmp(argv[1], "--loadgen") == 0) {
+        return run_loadgen(argc - 1, argv + 1);
+    }
+    if (argc >= 2 && std::strcmp(argv[1], "--pcap") == 0) {
+        return run_replay(argc - 1, argv + 1);
+    }
+    if (argc != 2) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    BridgeConfig config;
+    std::string error;
+    if (!config.load(argv[1], error)) {
+        std::fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+        return 2;
+    }
+
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    // Flat lookup table so remapping is a single load on the receive thread.
+    std::vector<uint16_t> remap(64000);
+    for (int u = 0; u < 64000; ++u) {
+        remap[u] = (uint16_t)u;
+    }
+    for (const BridgeConfig::Remap &entry : config.remaps) {
+        for (uint16_t i = 0; i < entry.count; ++i) {
+            remap[entry.first + i] = entry.target + i;
+        }
+    }
+
+    gacn::SendTarget target;
+    target.multicast = config.output_mode == BridgeConfig::OUTPUT_MULTICAST;
+    target.port = config.output_port;
+    target.priority = config.priority;
+    if (config.output_mode == BridgeConfig::OUTPUT_UNICAST) {
+        e131_addr_t resolved;
+        if (e131_unicast_dest(&resolved, config.destination.c_str(), config.output_port) < 0) {
+            std::fprintf(stderr, "cannot resolve destination %s\n", config.destination.c_str());
+            return 1;
+        }
+        target.unicast_addr = resolved.sin_addr.s_addr;
+    }
+
+    std::vector<gacn::NetInterface> input_interfaces;
+    std::vector<gacn::NetInterface> output_interfaces;
+    if (!gacn::resolve_interfaces(config.input_interfaces, input_interfaces) ||
+            !gacn::resolve_interfaces(config.output_interfaces, output_interfaces)) {
+        return 1;
+    }
+
+    gacn::SenderEngine sender;
+    if (config.output_mode != BridgeConfig::OUTPUT_NONE) {
+        sender.set_interfaces(output_interfaces);
+        for (const BridgeConfig::Binding &binding : config.output_bindings) {
+            for (uint16_t universe : binding.universes) {
+                sender.set_universe_interface(universe, binding.index);
+            }
+        }
+        sender.set_source_name(config.source_name.c_str());
+        sender.set_latency_tuning(config.output_tuning);
+        sender.set_worker_count(config.output_workers);
+        sender.set_congestion_policy(config.congestion);
+        sender.set_backlog_capacity(config.backlog);
+        sender.set_universe_backlog(config.universe_backlog);
+        sender.set_block_timeout(config.block_timeout_us);
+        sender.set_local_transport_port(config.output_local ? config.output_port : 0);
+        if (!sender.start(config.queue_capacity)) {
+            return 1;
+        }
+    }
+
+    gacn::PcapWriter recorder;
+    if (!config.record_path.empty() && !recorder.open(config.record_path.c_str())) {
+        return 1;
+    }
+
+    gacn::ReceiverEngine receiver(config.input_port);
+    receiver.set_latency_tuning(config.input_tuning);
+    receiver.set_merge_mode(config.merge);
+    receiver.get_memberships().set_max_sockets(config.max_sockets);
+    receiver.set_interfaces(input_interfaces);
+    receiver.set_local_transport(config.input_local);
+    receiver.set_loss_policy(config.loss);
+    receiver.set_fade_time((uint64_t)(config.fade_time * 1e9));
+    receiver.set_source_timeout((uint64_t)(config.source_timeout * 1e9));
+
+    const bool relay = config.output_mode != BridgeConfig::OUTPUT_NONE;
+    receiver.set_universe_callback([&](uint16_t universe, const uint8_t *data, uint16_t length) {
+        if (relay) {
+            sender.submit(remap[universe], data, length, target);
+        }
+    });
+    receiver.set_source_lost_callback([](const uint8_t *cid, uint16_t universe, bool terminated) {
+        gacn::log_info("gacn-bridge: source %02x%02x%02x%02x... %s universe %u",
+                cid[0], cid[1], cid[2], cid[3], terminated ? "terminated" : "timed out on", universe);
+    });
+    if (recorder.is_open()) {
+        receiver.set_packet_tap([&](const e131_packet_t &packet, size_t length, const e131_addr_t &from, const e131_addr_t &to, bool) {
+            recorder.write(packet.raw, length, from, to, gacn::realtime_ns());
+        });
+    }
+
+    if (!receiver.start()) {
+        return 1;
+    }
+    std::vector<uint8_t> input_interface(64000, 0);
+    for (const BridgeConfig::Binding &binding : config.input_bindings) {
+        for (uint16_t universe : binding.universes) {
+            input_interface[universe] = (uint8_t)binding.index;
+        }
+    }
+    int joined = 0;
+    for (uint16_t universe : config.universes) {
+        joined += receiver.get_memberships().join(universe, input_interface[universe]) ? 1 : 0;
+    }
+    gacn::MembershipManager::Capacity capacity = receiver.get_memberships().get_capacity();
+    gacn::log_info("gacn-bridge: listening on port %u, %d/%zu universes joined over %d sockets on %d interfaces",
+            config.input_port, joined, config.universes.size(), capacity.sockets, capacity.interfaces);
+
+    auto last_report = std::chrono::steady_clock::now();
+    gacn::ReceiverEngine::Stats last_stats;
+    while (!quit.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (config.stats_interval <= 0) {
+            continue;
+        }
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_report).count();
+        if (elapsed < config.stats_interval) {
+            continue;
+        }
+        gacn::ReceiverEngine::Stats stats = receiver.get_stats();
+        gacn::log_info("gacn-bridge: rx %.0f pkt/s, invalid %llu, out of order %llu, sources lost %llu, tx %llu, dropped %llu, coalesced %llu, congestion drops %llu",
+                (stats.packets - last_stats.packets) / elapsed,
+                (unsigned long long)stats.invalid, (unsigned long long)stats.out_of_order,
+                (unsigned long long)(stats.sources_lost + stats.sources_terminated),
+                (unsigned long long)sender.get_sent_count(), (unsigned long long)sender.get_dropped_count(),
+                (unsigned long long)sender.get_coalesced_count(), (unsigned long long)sender.get_congestion_dropped_count());
+        last_stats = stats;
+        last_report = now;
+    }
+
+    // Stop the producer first so the sender can drain its queue.
+    receiver.stop();
+    sender.stop();
+    recorder.close();
+    return 0;
+}
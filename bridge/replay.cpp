@@ -0,0 +1,132 @@
+// Offline replay: a PcapReplay feeds a stopped ReceiverEngine, which then runs
+// on the capture's clock, and the results of validation, sequencing and
+// merging are counted. At --max-speed this measures the pipeline's ceiling.
+
+#include "replay.hpp"
+
+#include "e131.h"
+#include "pcap_replay.hpp"
+#include "receiver_engine.hpp"
+#include "sacn_log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::atomic<bool> quit{ false };
+
+static void handle_signal(int) {
+    quit = true;
+}
+
+static void print_usage() {
+    std::fprintf(stderr,
+            "usage: gacn-bridge --pcap <capture> [options]\n"
+            "  --speed X         playback speed, 1 = recorded timing (default 1)\n"
+            "  --max-speed       feed as fast as possible, same as --speed 0\n"
+            "  --port P          destination port to take, 0 = any (default 5568)\n"
+            "  --merge M         latest or htp (default latest)\n"
+            "  --loss L          hold, blackout or fade (default hold)\n"
+            "  --source-timeout S source loss timeout in seconds (default 2.5)\n");
+}
+
+static void print_report(const gacn::PcapReplay::Report &replay, const gacn::ReceiverEngine::Stats &rx, uint64_t merged, bool final) {
+    if (!final) {
+        gacn::log_info("replay: %.1f s of capture, %llu datagrams, %.0f pkt/s, invalid %llu, out of order %llu",
+                replay.capture_time, (unsigned long long)replay.fed, replay.packet_rate,
+                (unsigned long long)rx.invalid, (unsigned long long)rx.out_of_order);
+        return;
+    }
+    std::printf("capture: %llu records, %llu not IPv4 UDP, %llu to other ports, %.2f s of traffic%s\n",
+            (unsigned long long)replay.frames, (unsigned long long)replay.skipped, (unsigned long long)replay.other_port,
+            replay.capture_time, replay.finished ? "" : " (interrupted)");
+    std::printf("pipeline: %llu datagrams in %.2f s, %.0f pkt/s, %.1fx real time\n",
+            (unsigned long long)replay.fed, replay.elapsed, replay.packet_rate,
+            replay.elapsed > 0.0 ? replay.capture_time / replay.elapsed : 0.0);
+    std::printf("receiver: %llu invalid, %llu out of order, %llu merged outputs, %llu sources lost, %llu terminated\n",
+            (unsigned long long)rx.invalid, (unsigned long long)rx.out_of_order, (unsigned long long)merged,
+            (unsigned long long)rx.sources_lost, (unsigned long long)rx.sources_terminated);
+}
+
+int run_replay(int argc, char **argv) {
+    if (argc < 2 || std::string(argv[1]) == "--help") {
+        print_usage();
+        return argc < 2 ? 2 : 0;
+    }
+    gacn::PcapReplay::Config config;
+    config.path = argv[1];
+    gacn::MergeMode merge = gacn::MERGE_LATEST;
+    gacn::LossPolicy loss = gacn::LOSS_HOLD;
+    double source_timeout = 2.5;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--help") {
+            print_usage();
+            return 0;
+        }
+        if (option == "--max-speed") {
+            config.speed = 0.0;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage();
+            return 2;
+        }
+        const std::string value = argv[++i];
+        if (option == "--speed") {
+            config.speed = std::atof(value.c_str());
+        } else if (option == "--port") {
+            config.port = (uint16_t)std::atoi(value.c_str());
+        } else if (option == "--merge" && (value == "htp" || value == "latest")) {
+            merge = value == "htp" ? gacn::MERGE_HTP : gacn::MERGE_LATEST;
+        } else if (option == "--loss" && (value == "hold" || value == "blackout" || value == "fade")) {
+            loss = value == "hold" ? gacn::LOSS_HOLD : (value == "blackout" ? gacn::LOSS_BLACKOUT : gacn::LOSS_FADE);
+        } else if (option == "--source-timeout") {
+            source_timeout = std::atof(value.c_str());
+        } else {
+            print_usage();
+            return 2;
+        }
+    }
+
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    // Never started: the replay drives it on its own thread.
+    gacn::ReceiverEngine receiver(config.port);
+    receiver.set_merge_mode(merge);
+    receiver.set_loss_policy(loss);
+    receiver.set_source_timeout((uint64_t)(std::max(source_timeout, 0.1) * 1e9));
+    std::atomic<uint64_t> merged{ 0 };
+    receiver.set_universe_callback([&](uint16_t, const uint8_t *, uint16_t) {
+        merged.fetch_add(1, std::memory_order_relaxed);
+    });
+    receiver.set_source_lost_callback([](const uint8_t *cid, uint16_t universe, bool terminated) {
+        gacn::log_info("replay: source %02x%02x%02x%02x... %s universe %u",
+                cid[0], cid[1], cid[2], cid[3], terminated ? "terminated" : "timed out on", universe);
+    });
+
+    gacn::PcapReplay replay;
+    if (!replay.start(receiver, config)) {
+        return 1;
+    }
+    auto last_report = std::chrono::steady_clock::now();
+    while (!quit.load() && replay.is_running()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_report >= std::chrono::seconds(1)) {
+            print_report(replay.get_report(), receiver.get_stats(), merged.load(), false);
+            last_report = now;
+        }
+    }
+    replay.stop();
+    print_report(replay.get_report(), receiver.get_stats(), merged.load(), true);
+    return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+// `gacn-bridge --pcap <capture> [options]`: runs a capture through the
+// receive pipeline without a network and prints what it saw. argv[0] is
+// "--pcap".
+int run_replay(int argc, char **argv);
+
+#endif
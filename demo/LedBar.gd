@@ -69,9 +69,20 @@ func _on_data_received(universe_id: int, data: PackedByteArray):
 			lights.append(child)
 
 	var light_chunk_size = 10 # One light for every 10 cubes
-	var num_chunks = ceil(float(length) / light_chunk_size)
 
-	for chunk_index in range(num_chunks):
+	# Only touch the cubes whose slots moved; the receiver diffs each frame.
+	var ranges: PackedInt32Array = receiver.get_changed_ranges(universe_id)
+	var dirty_chunks = {}
+	for r in range(0, ranges.size(), 2):
+		var first_cube = floori(ranges[r] / 3.0)
+		var last_cube = floori((ranges[r] + ranges[r + 1] - 1) / 3.0)
+		for cube_index in range(first_cube, min(last_cube + 1, cubes.size(), length)):
+			_update_cube(cubes[cube_index], cube_index, data)
+			dirty_chunks[floori(cube_index / float(light_chunk_size))] = true
+
+	for chunk_index in dirty_chunks:
+		if chunk_index >= lights.size():
+			continue
 		var avg_r = 0.0
 		var avg_g = 0.0
 		var avg_b = 0.0
@@ -81,38 +92,37 @@ func _on_data_received(universe_id: int, data: PackedByteArray):
 			var cube_index = chunk_index * light_chunk_size + i
 			if cube_index >= cubes.size():
 				break
-
-			var dmx_start_index = cube_index * 3
-			if dmx_start_index >= data.size():
-				break
-
-			var r = float(data[dmx_start_index]) / 255.0
-			var g = float(data[dmx_start_index+1]) / 255.0 if dmx_start_index + 1 < data.size() else 0.0
-			var b = float(data[dmx_start_index+2]) / 255.0 if dmx_start_index + 2 < data.size() else 0.0
-			var color = Color(r, g, b)
-
-			var cube = cubes[cube_index]
-			if not cube.mesh:
-				cube.mesh = BoxMesh.new()
-				(cube.mesh as BoxMesh).size = Vector3(0.05, 0.05, 0.05) # Ensure consistent size
-
-			var material = cube.get_active_material(0)
-			if not material:
-				material = StandardMaterial3D.new()
-				cube.set_surface_override_material(0, material)
-			
-			if material is StandardMaterial3D:
-				material.albedo_color = color # Still set albedo for base color
-				material.emission_enabled = true
-				material.emission = color
-				material.emission_energy_multiplier = strength # Adjust as needed for brightness
-			
-			avg_r += r
-			avg_g += g
-			avg_b += b
+			var color = _slot_color(cube_index, data)
+			avg_r += color.r
+			avg_g += color.g
+			avg_b += color.b
 			cube_count_in_chunk += 1
-		
-		if cube_count_in_chunk > 0 and chunk_index < lights.size():
+
+		if cube_count_in_chunk > 0:
 			var avg_color = Color(avg_r / cube_count_in_chunk, avg_g / cube_count_in_chunk, avg_b / cube_count_in_chunk)
 			var light: OmniLight3D = lights[chunk_index]
 			light.light_color = avg_color
+
+func _slot_color(cube_index: int, data: PackedByteArray) -> Color:
+	var dmx_start_index = cube_index * 3
+	var r = float(data[dmx_start_index]) / 255.0 if dmx_start_index < data.size() else 0.0
+	var g = float(data[dmx_start_index+1]) / 255.0 if dmx_start_index + 1 < data.size() else 0.0
+	var b = float(data[dmx_start_index+2]) / 255.0 if dmx_start_index + 2 < data.size() else 0.0
+	return Color(r, g, b)
+
+func _update_cube(cube: MeshInstance3D, cube_index: int, data: PackedByteArray) -> void:
+	var color = _slot_color(cube_index, data)
+	if not cube.mesh:
+		cube.mesh = BoxMesh.new()
+		(cube.mesh as BoxMesh).size = Vector3(0.05, 0.05, 0.05) # Ensure consistent size
+
+	var material = cube.get_active_material(0)
+	if not material:
+		material = StandardMaterial3D.new()
+		cube.set_surface_override_material(0, material)
+
+	if material is StandardMaterial3D:
+		material.albedo_color = color # Still set albedo for base color
+		material.emission_enabled = true
+		material.emission = color
+		material.emission_energy_multiplier = strength # Adjust as needed for brightness
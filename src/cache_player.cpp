@@ -0,0 +1,194 @@
+#include "cache_player.hpp"
+#include "sender.hpp"
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace godot {
+
+void SacnCachePlayer::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_cache", "cache"), &SacnCachePlayer::set_cache);
+    ClassDB::bind_method(D_METHOD("get_cache"), &SacnCachePlayer::get_cache);
+    ClassDB::add_property("SacnCachePlayer", PropertyInfo(Variant::OBJECT, "cache", PROPERTY_HINT_RESOURCE_TYPE, "SacnFrameCache"), "set_cache", "get_cache");
+
+    ClassDB::bind_method(D_METHOD("set_sender_path", "path"), &SacnCachePlayer::set_sender_path);
+    ClassDB::bind_method(D_METHOD("get_sender_path"), &SacnCachePlayer::get_sender_path);
+    ClassDB::add_property("SacnCachePlayer", PropertyInfo(Variant::NODE_PATH, "sender_path", PROPERTY_HINT_NODE_PATH_VALID_TYPES, "SacnSender"), "set_sender_path", "get_sender_path");
+
+    ClassDB::bind_method(D_METHOD("set_playing", "playing"), &SacnCachePlayer::set_playing);
+    ClassDB::bind_method(D_METHOD("is_playing"), &SacnCachePlayer::is_playing);
+    ClassDB::add_property("SacnCachePlayer", PropertyInfo(Variant::BOOL, "playing"), "set_playing", "is_playing");
+
+    ClassDB::bind_method(D_METHOD("set_loop", "loop"), &SacnCachePlayer::set_loop);
+    ClassDB::bind_method(D_METHOD("get_loop"), &SacnCachePlayer::get_loop);
+    ClassDB::add_property("SacnCachePlayer", PropertyInfo(Variant::BOOL, "loop"), "set_loop", "get_loop");
+
+    ClassDB::bind_method(D_METHOD("set_speed", "speed"), &SacnCachePlayer::set_speed);
+    ClassDB::bind_method(D_METHOD("get_speed"), &SacnCachePlayer::get_speed);
+    ClassDB::add_property("SacnCachePlayer", PropertyInfo(Variant::FLOAT, "speed"), "set_speed", "get_speed");
+
+    ClassDB::bind_method(D_METHOD("set_position", "position"), &SacnCachePlayer::set_position);
+    ClassDB::bind_method(D_METHOD("get_position"), &SacnCachePlayer::get_position);
+    ClassDB::add_property("SacnCachePlayer", PropertyInfo(Variant::FLOAT, "position"), "set_position", "get_position");
+
+    ClassDB::bind_method(D_METHOD("play"), &SacnCachePlayer::play);
+    ClassDB::bind_method(D_METHOD("stop"), &SacnCachePlayer::stop);
+    ClassDB::bind_method(D_METHOD("seek", "position"), &SacnCachePlayer::seek);
+    ClassDB::bind_method(D_METHOD("get_current_frame"), &SacnCachePlayer::get_current_frame);
+
+    ClassDB::add_signal(get_class_static(), MethodInfo("finished"));
+}
+
+void SacnCachePlayer::set_cache(const Ref<SacnFrameCache> &p_cache) {
+    cache = p_cache;
+    cursor.reset(nullptr);
+    sent_frame = -1;
+}
+
+Ref<SacnFrameCache> SacnCachePlayer::get_cache() const {
+    return cache;
+}
+
+void SacnCachePlayer::set_sender_path(const NodePath &p_path) {
+    sender_path = p_path;
+}
+
+NodePath SacnCachePlayer::get_sender_path() const {
+    return sender_path;
+}
+
+void SacnCachePlayer::set_playing(bool p_playing) {
+    playing = p_playing;
+}
+
+bool SacnCachePlayer::is_playing() const {
+    return playing;
+}
+
+void SacnCachePlayer::set_loop(bool p_loop) {
+    loop = p_loop;
+}
+
+bool SacnCachePlayer::get_loop() const {
+    return loop;
+}
+
+void SacnCachePlayer::set_speed(double p_speed) {
+    speed = p_speed;
+}
+
+double SacnCachePlayer::get_speed() const {
+    return speed;
+}
+
+void SacnCachePlayer::set_position(double p_position) {
+    seek(p_position);
+}
+
+double SacnCachePlayer::get_position() const {
+    return position;
+}
+
+void SacnCachePlayer::play() {
+    if (cache.is_valid() && speed >= 0.0 && _frame_at(position) >= cache->get_frame_count() - 1) {
+        position = 0.0; // replay from the start once finished
+    }
+    playing = true;
+}
+
+void SacnCachePlayer::stop() {
+    playing = false;
+    sent_frame = -1;
+}
+
+void SacnCachePlayer::seek(double p_position) {
+    const double duration = cache.is_valid() ? cache->get_duration() : 0.0;
+    position = std::max(0.0, std::min(p_position, duration));
+    if (is_inside_tree() && cache.is_valid() && cache->get_frame_count() > 0) {
+        _send_frame(_frame_at(position));
+    }
+}
+
+int SacnCachePlayer::get_current_frame() const {
+    return cursor.get_frame();
+}
+
+SacnSender *SacnCachePlayer::_get_sender() const {
+    if (sender_path.is_empty()) {
+        return nullptr;
+    }
+    return Object::cast_to<SacnSender>(get_node_or_null(sender_path));
+}
+
+int SacnCachePlayer::_frame_at(double p_position) const {
+    const int count = cache->get_frame_count();
+    const int frame = (int)std::floor(p_position * cache->get_fps());
+    return std::max(0, std::min(frame, count - 1));
+}
+
+void SacnCachePlayer::_send_frame(int p_frame) {
+    SacnSender *sender = _get_sender();
+    if (sender == nullptr) {
+        return;
+    }
+    // A re-baked or reloaded cache invalidates the decoded state.
+    const gacn::FrameCache &frames = cache->get_cache();
+    if (cursor_version != cache->get_version() || cursor.get_frame() < 0) {
+        cursor.reset(&frames);
+        cursor_version = cache->get_version();
+    }
+    if (!cursor.seek(p_frame)) {
+        UtilityFunctions::printerr("SacnCachePlayer: cannot decode frame ", p_frame);
+        playing = false;
+        sent_frame = -1;
+        return;
+    }
+    const std::vector<uint16_t> &universes = frames.get_universes();
+    for (size_t i = 0; i < universes.size(); ++i) {
+        const uint16_t length = cursor.get_length((int)i);
+        if (length > 0) {
+            sender->submit_universe(universes[i], cursor.get_data((int)i), length);
+        }
+    }
+    sent_frame = p_frame;
+    since_send = 0.0;
+}
+
+void SacnCachePlayer::_ready() {
+    set_process(!Engine::get_singleton()->is_editor_hint());
+}
+
+void SacnCachePlayer::_process(double delta) {
+    if (cache.is_null() || cache->get_frame_count() == 0) {
+        return;
+    }
+    since_send += delta;
+
+    if (playing) {
+        const double duration = cache->get_duration();
+        position += delta * speed;
+        if (position >= duration || position < 0.0) {
+            if (loop && duration > 0.0) {
+                position = std::fmod(position, duration);
+                if (position < 0.0) {
+                    position += duration;
+                }
+            } else {
+                position = std::max(0.0, std::min(position, duration));
+                playing = false;
+                emit_signal("finished");
+            }
+        }
+    }
+
+    const int frame = _frame_at(position);
+    if (playing || sent_frame >= 0) {
+        if (frame != sent_frame || cursor_version != cache->get_version() || since_send >= KEEPALIVE_INTERVAL) {
+            _send_frame(frame);
+        }
+    }
+}
+
+}
@@ -0,0 +1,75 @@
+#ifndef CACHE_PLAYER_HPP
+#define CACHE_PLAYER_HPP
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+#include "frame_cache.hpp"
+#include "frame_codec.hpp"
+
+namespace godot {
+
+class SacnSender;
+
+// Streams a SacnFrameCache straight into a SacnSender: each frame costs a
+// delta decode and the submits, with no scene evaluation. Setting position
+// seeks, so dragging it scrubs the output live. While paused the current look
+// is repeated once a second so receivers keep it; stop() ends the output.
+class SacnCachePlayer : public Node {
+    GDCLASS(SacnCachePlayer, Node);
+
+public:
+    static constexpr double KEEPALIVE_INTERVAL = 1.0;
+
+private:
+    Ref<SacnFrameCache> cache;
+    NodePath sender_path;
+    bool playing = false;
+    bool loop = false;
+    double speed = 1.0;
+    double position = 0.0;
+
+    gacn::FrameCacheCursor cursor;
+    uint64_t cursor_version = 0;
+    int sent_frame = -1; // -1 when there is no output to keep alive
+    double since_send = 0.0;
+
+    SacnSender *_get_sender() const;
+    void _send_frame(int p_frame);
+    int _frame_at(double p_position) const;
+
+protected:
+    static void _bind_methods();
+
+public:
+    void set_cache(const Ref<SacnFrameCache> &p_cache);
+    Ref<SacnFrameCache> get_cache() const;
+
+    void set_sender_path(const NodePath &p_path);
+    NodePath get_sender_path() const;
+
+    void set_playing(bool p_playing);
+    bool is_playing() const;
+
+    void set_loop(bool p_loop);
+    bool get_loop() const;
+
+    // Negative speeds play backwards.
+    void set_speed(double p_speed);
+    double get_speed() const;
+
+    void set_position(double p_position);
+    double get_position() const;
+
+    void play();
+    void stop();
+    void seek(double p_position);
+    int get_current_frame() const;
+
+    void _ready() override;
+    void _process(double delta) override;
+};
+
+}
+
+#endif
@@ -0,0 +1,169 @@
+#include "effect_engine.hpp"
+#include "sender.hpp"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+
+namespace godot {
+
+void SacnEffectEngine::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_sender_path", "path"), &SacnEffectEngine::set_sender_path);
+    ClassDB::bind_method(D_METHOD("get_sender_path"), &SacnEffectEngine::get_sender_path);
+    ClassDB::add_property("SacnEffectEngine", PropertyInfo(Variant::NODE_PATH, "sender_path", PROPERTY_HINT_NODE_PATH_VALID_TYPES, "SacnSender"), "set_sender_path", "get_sender_path");
+
+    ClassDB::bind_method(D_METHOD("set_layers", "layers"), &SacnEffectEngine::set_layers);
+    ClassDB::bind_method(D_METHOD("get_layers"), &SacnEffectEngine::get_layers);
+    ClassDB::add_property("SacnEffectEngine", PropertyInfo(Variant::ARRAY, "layers", PROPERTY_HINT_TYPE_STRING, String::num_int64(Variant::OBJECT) + "/" + String::num_int64(PROPERTY_HINT_RESOURCE_TYPE) + ":SacnEffectLayer"), "set_layers", "get_layers");
+
+    ClassDB::bind_method(D_METHOD("set_pixel_count", "count"), &SacnEffectEngine::set_pixel_count);
+    ClassDB::bind_method(D_METHOD("get_pixel_count"), &SacnEffectEngine::get_pixel_count);
+    ClassDB::add_property("SacnEffectEngine", PropertyInfo(Variant::INT, "pixel_count", PROPERTY_HINT_RANGE, "1,65535,1,or_greater"), "set_pixel_count", "get_pixel_count");
+
+    ClassDB::bind_method(D_METHOD("set_start_universe", "universe_id"), &SacnEffectEngine::set_start_universe);
+    ClassDB::bind_method(D_METHOD("get_start_universe"), &SacnEffectEngine::get_start_universe);
+    ClassDB::add_property("SacnEffectEngine", PropertyInfo(Variant::INT, "start_universe", PROPERTY_HINT_RANGE, "1,63999,1"), "set_start_universe", "get_start_universe");
+
+    ClassDB::bind_method(D_METHOD("set_channel_order", "order"), &SacnEffectEngine::set_channel_order);
+    ClassDB::bind_method(D_METHOD("get_channel_order"), &SacnEffectEngine::get_channel_order);
+    ClassDB::add_property("SacnEffectEngine", PropertyInfo(Variant::INT, "channel_order", PROPERTY_HINT_ENUM, "RGB,GRB,BGR"), "set_channel_order", "get_channel_order");
+
+    ClassDB::bind_method(D_METHOD("set_playing", "playing"), &SacnEffectEngine::set_playing);
+    ClassDB::bind_method(D_METHOD("is_playing"), &SacnEffectEngine::is_playing);
+    ClassDB::add_property("SacnEffectEngine", PropertyInfo(Variant::BOOL, "playing"), "set_playing", "is_playing");
+
+    ClassDB::bind_method(D_METHOD("set_time", "time"), &SacnEffectEngine::set_time);
+    ClassDB::bind_method(D_METHOD("get_time"), &SacnEffectEngine::get_time);
+    ClassDB::add_property("SacnEffectEngine", PropertyInfo(Variant::FLOAT, "time"), "set_time", "get_time");
+
+    ClassDB::bind_method(D_METHOD("set_time_scale", "scale"), &SacnEffectEngine::set_time_scale);
+    ClassDB::bind_method(D_METHOD("get_time_scale"), &SacnEffectEngine::get_time_scale);
+    ClassDB::add_property("SacnEffectEngine", PropertyInfo(Variant::FLOAT, "time_scale"), "set_time_scale", "get_time_scale");
+
+    ClassDB::bind_method(D_METHOD("get_universe_count"), &SacnEffectEngine::get_universe_count);
+    ClassDB::bind_method(D_METHOD("render", "time"), &SacnEffectEngine::render);
+
+    BIND_ENUM_CONSTANT(ORDER_RGB);
+    BIND_ENUM_CONSTANT(ORDER_GRB);
+    BIND_ENUM_CONSTANT(ORDER_BGR);
+}
+
+void SacnEffectEngine::set_sender_path(const NodePath &p_path) {
+    sender_path = p_path;
+}
+
+NodePath SacnEffectEngine::get_sender_path() const {
+    return sender_path;
+}
+
+void SacnEffectEngine::set_layers(const TypedArray<SacnEffectLayer> &p_layers) {
+    layers = p_layers;
+}
+
+TypedArray<SacnEffectLayer> SacnEffectEngine::get_layers() const {
+    return layers;
+}
+
+void SacnEffectEngine::set_pixel_count(int p_count) {
+    pixel_count = std::max(p_count, 1);
+}
+
+int SacnEffectEngine::get_pixel_count() const {
+    return pixel_count;
+}
+
+void SacnEffectEngine::set_start_universe(int p_universe) {
+    start_universe = p_universe;
+}
+
+int SacnEffectEngine::get_start_universe() const {
+    return start_universe;
+}
+
+void SacnEffectEngine::set_channel_order(ChannelOrder p_order) {
+    channel_order = p_order;
+}
+
+SacnEffectEngine::ChannelOrder SacnEffectEngine::get_channel_order() const {
+    return channel_order;
+}
+
+void SacnEffectEngine::set_playing(bool p_playing) {
+    playing = p_playing;
+}
+
+bool SacnEffectEngine::is_playing() const {
+    return playing;
+}
+
+void SacnEffectEngine::set_time(double p_time) {
+    time = p_time;
+}
+
+double SacnEffectEngine::get_time() const {
+    return time;
+}
+
+void SacnEffectEngine::set_time_scale(double p_scale) {
+    time_scale = p_scale;
+}
+
+double SacnEffectEngine::get_time_scale() const {
+    return time_scale;
+}
+
+int SacnEffectEngine::get_universe_count() const {
+    return (pixel_count + PIXELS_PER_UNIVERSE - 1) / PIXELS_PER_UNIVERSE;
+}
+
+SacnSender *SacnEffectEngine::_get_sender() const {
+    if (sender_path.is_empty()) {
+        return nullptr;
+    }
+    return Object::cast_to<SacnSender>(get_node_or_null(sender_path));
+}
+
+void SacnEffectEngine::render(double p_time) {
+    SacnSender *sender = _get_sender();
+    if (sender == nullptr) {
+        return;
+    }
+
+    if (pixels.size() != (size_t)pixel_count) {
+        pixels.resize(pixel_count);
+        scratch.resize(pixel_count);
+    }
+    pixels.clear();
+
+    for (int64_t i = 0; i < layers.size(); ++i) {
+        Ref<SacnEffectLayer> layer = layers[i];
+        if (layer.is_valid()) {
+            gacn::render_layer(layer->get_params(), p_time, scratch, pixels);
+        }
+    }
+
+    const gacn::ChannelOrder order = (gacn::ChannelOrder)channel_order;
+    const int universe_count = get_universe_count();
+    for (int u = 0; u < universe_count; ++u) {
+        const size_t first = (size_t)u * PIXELS_PER_UNIVERSE;
+        const size_t count = std::min((size_t)PIXELS_PER_UNIVERSE, (size_t)pixel_count - first);
+        sender->submit_universe_with(start_universe + u, count * 3, [&](uint8_t *out) {
+            gacn::quantize_pixels(pixels, first, count, order, out);
+        });
+    }
+}
+
+void SacnEffectEngine::_ready() {
+    set_process(!Engine::get_singleton()->is_editor_hint());
+}
+
+void SacnEffectEngine::_process(double delta) {
+    if (!playing) {
+        return;
+    }
+    time += delta * time_scale;
+    render(time);
+}
+
+}
@@ -0,0 +1,86 @@
+#ifndef EFFECT_ENGINE_HPP
+#define EFFECT_ENGINE_HPP
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+
+#include "effect_kernels.hpp"
+#include "effect_layer.hpp"
+
+namespace godot {
+
+class SacnSender;
+
+// Renders a stack of SacnEffectLayer resources over a strip of RGB pixels and
+// writes the result straight into the sender's universe queue every frame.
+// Pixels are packed 170 per universe, starting at start_universe.
+class SacnEffectEngine : public Node {
+    GDCLASS(SacnEffectEngine, Node);
+
+public:
+    enum ChannelOrder {
+        ORDER_RGB = gacn::ORDER_RGB,
+        ORDER_GRB = gacn::ORDER_GRB,
+        ORDER_BGR = gacn::ORDER_BGR,
+    };
+
+    static const int PIXELS_PER_UNIVERSE = 170;
+
+private:
+    NodePath sender_path;
+    TypedArray<SacnEffectLayer> layers;
+    int pixel_count = PIXELS_PER_UNIVERSE;
+    int start_universe = 1;
+    ChannelOrder channel_order = ORDER_RGB;
+    bool playing = true;
+    double time = 0.0;
+    double time_scale = 1.0;
+
+    gacn::PixelBuffer pixels;
+    gacn::PixelBuffer scratch;
+
+    SacnSender *_get_sender() const;
+
+protected:
+    static void _bind_methods();
+
+public:
+    void set_sender_path(const NodePath &p_path);
+    NodePath get_sender_path() const;
+
+    void set_layers(const TypedArray<SacnEffectLayer> &p_layers);
+    TypedArray<SacnEffectLayer> get_layers() const;
+
+    void set_pixel_count(int p_count);
+    int get_pixel_count() const;
+
+    void set_start_universe(int p_universe);
+    int get_start_universe() const;
+
+    void set_channel_order(ChannelOrder p_order);
+    ChannelOrder get_channel_order() const;
+
+    void set_playing(bool p_playing);
+    bool is_playing() const;
+
+    void set_time(double p_time);
+    double get_time() const;
+
+    void set_time_scale(double p_scale);
+    double get_time_scale() const;
+
+    int get_universe_count() const;
+
+    // Evaluates all layers at p_time and submits the universes.
+    void render(double p_time);
+
+    void _ready() override;
+    void _process(double delta) override;
+};
+
+}
+
+VARIANT_ENUM_CAST(SacnEffectEngine::ChannelOrder);
+
+#endif
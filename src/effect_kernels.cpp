@@ -0,0 +1,195 @@
+#include "effect_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gacn {
+
+static const double TAU = 6.28318530717958647692;
+
+void PixelBuffer::resize(size_t count) {
+    r.resize(count);
+    g.resize(count);
+    b.resize(count);
+}
+
+void PixelBuffer::clear() {
+    std::fill(r.begin(), r.end(), 0.0f);
+    std::fill(g.begin(), g.end(), 0.0f);
+    std::fill(b.begin(), b.end(), 0.0f);
+}
+
+static inline float fract(float x) {
+    return x - std::floor(x);
+}
+
+// Integer lattice hash for value noise, mapped to [0, 1).
+static inline float hash2(int32_t x, int32_t y, uint32_t seed) {
+    uint32_t h = (uint32_t)x * 0x8da6b343u ^ (uint32_t)y * 0xd8163841u ^ seed * 0xcb1ab31fu;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    h *= 0x297a2d39u;
+    h ^= h >> 15;
+    return (float)(h >> 8) * (1.0f / 16777216.0f);
+}
+
+// Fills t[0, count) with the mix factor between color_b (0) and color_a (1).
+static void compute_mix(const EffectParams &p, double time, float *t, size_t count) {
+    const float n = (float)count;
+    const float size = std::max(p.size, 0.001f);
+
+    switch (p.type) {
+        case EFFECT_SOLID: {
+            std::fill(t, t + count, 1.0f);
+        } break;
+        case EFFECT_CHASE: {
+            // Triangular pulse of `size` pixels travelling around the range.
+            const float head = (float)std::fmod(time * p.speed, (double)n);
+            const float inv_half = 2.0f / size;
+            for (size_t i = 0; i < count; ++i) {
+                float d = (float)i - head;
+                d -= n * std::floor(d / n);
+                float dist = std::min(d, n - d);
+                t[i] = std::max(0.0f, 1.0f - dist * inv_half);
+            }
+        } break;
+        case EFFECT_GRADIENT: {
+            // Triangle wave so the gradient wraps without a seam.
+            const float offset = (float)(time * p.speed - std::floor(time * p.speed));
+            const float inv_size = 1.0f / size;
+            for (size_t i = 0; i < count; ++i) {
+                float f = fract((float)i * inv_size + offset);
+                t[i] = 1.0f - std::fabs(2.0f * f - 1.0f);
+            }
+        } break;
+        case EFFECT_NOISE: {
+            // 2D value noise: space along the strip, time along the other axis.
+            const double y = time * p.speed;
+            const int32_t y0 = (int32_t)std::floor(y);
+            float fy = (float)(y - y0);
+            fy = fy * fy * (3.0f - 2.0f * fy);
+            const float inv_size = 1.0f / size;
+            for (size_t i = 0; i < count; ++i) {
+                float x = (float)i * inv_size;
+                int32_t x0 = (int32_t)x;
+                float fx = x - (float)x0;
+                fx = fx * fx * (3.0f - 2.0f * fx);
+                float a = hash2(x0, y0, p.seed);
+                float b = hash2(x0 + 1, y0, p.seed);
+                float c = hash2(x0, y0 + 1, p.seed);
+                float d = hash2(x0 + 1, y0 + 1, p.seed);
+                float top = a + (b - a) * fx;
+                float bottom = c + (d - c) * fx;
+                t[i] = top + (bottom - top) * fy;
+            }
+        } break;
+        case EFFECT_STROBE: {
+            const float f = (float)(time * p.speed - std::floor(time * p.speed));
+            std::fill(t, t + count, f < p.duty ? 1.0f : 0.0f);
+        } break;
+        case EFFECT_FADE: {
+            const float v = (float)(0.5 - 0.5 * std::cos(TAU * time * p.speed));
+            std::fill(t, t + count, v);
+        } break;
+    }
+}
+
+void render_layer(const EffectParams &params, double time, PixelBuffer &scratch, PixelBuffer &target) {
+    const size_t total = target.size();
+    if (params.opacity <= 0.0f || params.pixel_offset < 0 || (size_t)params.pixel_offset >= total) {
+        return;
+    }
+    const size_t first = (size_t)params.pixel_offset;
+    size_t count = total - first;
+    if (params.pixel_count > 0) {
+        count = std::min(count, (size_t)params.pixel_count);
+    }
+    if (scratch.size() < count) {
+        scratch.resize(total);
+    }
+
+    // scratch.r holds the mix factor until the red channel is written last.
+    float *sr = scratch.r.data();
+    float *sg = scratch.g.data();
+    float *sb = scratch.b.data();
+    compute_mix(params, time, sr, count);
+
+    const float *a = params.color_a;
+    const float *b = params.color_b;
+    const float dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+    for (size_t i = 0; i < count; ++i) {
+        float t = sr[i];
+        sg[i] = b[1] + dg * t;
+        sb[i] = b[2] + db * t;
+        sr[i] = b[0] + dr * t;
+    }
+
+    float *tr = target.r.data() + first;
+    float *tg = target.g.data() + first;
+    float *tb = target.b.data() + first;
+    const float op = std::min(params.opacity, 1.0f);
+
+    switch (params.blend) {
+        case BLEND_NORMAL: {
+            for (size_t i = 0; i < count; ++i) {
+                tr[i] += (sr[i] - tr[i]) * op;
+                tg[i] += (sg[i] - tg[i]) * op;
+                tb[i] += (sb[i] - tb[i]) * op;
+            }
+        } break;
+        case BLEND_ADD: {
+            for (size_t i = 0; i < count; ++i) {
+                tr[i] += sr[i] * op;
+                tg[i] += sg[i] * op;
+                tb[i] += sb[i] * op;
+            }
+        } break;
+        case BLEND_MULTIPLY: {
+            for (size_t i = 0; i < count; ++i) {
+                tr[i] *= 1.0f + (sr[i] - 1.0f) * op;
+                tg[i] *= 1.0f + (sg[i] - 1.0f) * op;
+                tb[i] *= 1.0f + (sb[i] - 1.0f) * op;
+            }
+        } break;
+        case BLEND_MAX: {
+            for (size_t i = 0; i < count; ++i) {
+                tr[i] += (std::max(tr[i], sr[i]) - tr[i]) * op;
+                tg[i] += (std::max(tg[i], sg[i]) - tg[i]) * op;
+                tb[i] += (std::max(tb[i], sb[i]) - tb[i]) * op;
+            }
+        } break;
+        case BLEND_SUBTRACT: {
+            for (size_t i = 0; i < count; ++i) {
+                tr[i] -= sr[i] * op;
+                tg[i] -= sg[i] * op;
+                tb[i] -= sb[i] * op;
+            }
+        } break;
+    }
+}
+
+static inline uint8_t to_byte(float v) {
+    return (uint8_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+void quantize_pixels(const PixelBuffer &pixels, size_t first, size_t count, ChannelOrder order, uint8_t *out) {
+    const float *c0 = pixels.r.data();
+    const float *c1 = pixels.g.data();
+    const float *c2 = pixels.b.data();
+    if (order == ORDER_GRB) {
+        std::swap(c0, c1);
+    } else if (order == ORDER_BGR) {
+        std::swap(c0, c2);
+    }
+    c0 += first;
+    c1 += first;
+    c2 += first;
+    for (size_t i = 0; i < count; ++i) {
+        out[i * 3 + 0] = to_byte(c0[i]);
+        out[i * 3 + 1] = to_byte(c1[i]);
+        out[i * 3 + 2] = to_byte(c2[i]);
+    }
+}
+
+}
@@ -0,0 +1,69 @@
+#ifndef EFFECT_KERNELS_HPP
+#define EFFECT_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gacn {
+
+enum EffectType {
+    EFFECT_SOLID,
+    EFFECT_CHASE,
+    EFFECT_GRADIENT,
+    EFFECT_NOISE,
+    EFFECT_STROBE,
+    EFFECT_FADE,
+};
+
+enum BlendMode {
+    BLEND_NORMAL,
+    BLEND_ADD,
+    BLEND_MULTIPLY,
+    BLEND_MAX,
+    BLEND_SUBTRACT,
+};
+
+enum ChannelOrder {
+    ORDER_RGB,
+    ORDER_GRB,
+    ORDER_BGR,
+};
+
+// Plain parameter block for one effect layer, filled from SacnEffectLayer.
+struct EffectParams {
+    EffectType type = EFFECT_SOLID;
+    BlendMode blend = BLEND_NORMAL;
+    float opacity = 1.0f;
+    float color_a[3] = { 1.0f, 1.0f, 1.0f };
+    float color_b[3] = { 0.0f, 0.0f, 0.0f };
+    float speed = 1.0f; // pixels/s for chases, cycles/s otherwise
+    float size = 10.0f; // chase width / gradient and noise scale, in pixels
+    float duty = 0.5f; // strobe on-time fraction
+    uint32_t seed = 0;
+    int pixel_offset = 0;
+    int pixel_count = 0; // 0 = up to the end of the buffer
+};
+
+// Structure-of-arrays float RGB buffer so every kernel is a straight loop
+// over contiguous floats the compiler can vectorize.
+struct PixelBuffer {
+    std::vector<float> r;
+    std::vector<float> g;
+    std::vector<float> b;
+
+    void resize(size_t count);
+    void clear();
+    size_t size() const { return r.size(); }
+};
+
+// Renders one effect into scratch (only the layer's pixel range is written)
+// and blends it into target.
+void render_layer(const EffectParams &params, double time, PixelBuffer &scratch, PixelBuffer &target);
+
+// Converts pixels [first, first + count) to 8-bit channels in the given order.
+void quantize_pixels(const PixelBuffer &pixels, size_t first, size_t count, ChannelOrder order, uint8_t *out);
+
+}
+
+#endif
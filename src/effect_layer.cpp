@@ -0,0 +1,196 @@
+#include "effect_layer.hpp"
+
+namespace godot {
+
+void SacnEffectLayer::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_enabled", "enabled"), &SacnEffectLayer::set_enabled);
+    ClassDB::bind_method(D_METHOD("is_enabled"), &SacnEffectLayer::is_enabled);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::BOOL, "enabled"), "set_enabled", "is_enabled");
+
+    ClassDB::bind_method(D_METHOD("set_effect", "effect"), &SacnEffectLayer::set_effect);
+    ClassDB::bind_method(D_METHOD("get_effect"), &SacnEffectLayer::get_effect);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::INT, "effect", PROPERTY_HINT_ENUM, "Solid,Chase,Gradient,Noise,Strobe,Fade"), "set_effect", "get_effect");
+
+    ClassDB::bind_method(D_METHOD("set_blend_mode", "mode"), &SacnEffectLayer::set_blend_mode);
+    ClassDB::bind_method(D_METHOD("get_blend_mode"), &SacnEffectLayer::get_blend_mode);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::INT, "blend_mode", PROPERTY_HINT_ENUM, "Normal,Add,Multiply,Max,Subtract"), "set_blend_mode", "get_blend_mode");
+
+    ClassDB::bind_method(D_METHOD("set_opacity", "opacity"), &SacnEffectLayer::set_opacity);
+    ClassDB::bind_method(D_METHOD("get_opacity"), &SacnEffectLayer::get_opacity);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::FLOAT, "opacity", PROPERTY_HINT_RANGE, "0,1,0.001"), "set_opacity", "get_opacity");
+
+    ClassDB::bind_method(D_METHOD("set_color_a", "color"), &SacnEffectLayer::set_color_a);
+    ClassDB::bind_method(D_METHOD("get_color_a"), &SacnEffectLayer::get_color_a);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::COLOR, "color_a"), "set_color_a", "get_color_a");
+
+    ClassDB::bind_method(D_METHOD("set_color_b", "color"), &SacnEffectLayer::set_color_b);
+    ClassDB::bind_method(D_METHOD("get_color_b"), &SacnEffectLayer::get_color_b);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::COLOR, "color_b"), "set_color_b", "get_color_b");
+
+    ClassDB::bind_method(D_METHOD("set_speed", "speed"), &SacnEffectLayer::set_speed);
+    ClassDB::bind_method(D_METHOD("get_speed"), &SacnEffectLayer::get_speed);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::FLOAT, "speed"), "set_speed", "get_speed");
+
+    ClassDB::bind_method(D_METHOD("set_size", "size"), &SacnEffectLayer::set_size);
+    ClassDB::bind_method(D_METHOD("get_size"), &SacnEffectLayer::get_size);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::FLOAT, "size", PROPERTY_HINT_RANGE, "0.001,512,0.001,or_greater"), "set_size", "get_size");
+
+    ClassDB::bind_method(D_METHOD("set_duty", "duty"), &SacnEffectLayer::set_duty);
+    ClassDB::bind_method(D_METHOD("get_duty"), &SacnEffectLayer::get_duty);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::FLOAT, "duty", PROPERTY_HINT_RANGE, "0,1,0.001"), "set_duty", "get_duty");
+
+    ClassDB::bind_method(D_METHOD("set_seed", "seed"), &SacnEffectLayer::set_seed);
+    ClassDB::bind_method(D_METHOD("get_seed"), &SacnEffectLayer::get_seed);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
+
+    ClassDB::bind_method(D_METHOD("set_pixel_offset", "offset"), &SacnEffectLayer::set_pixel_offset);
+    ClassDB::bind_method(D_METHOD("get_pixel_offset"), &SacnEffectLayer::get_pixel_offset);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::INT, "pixel_offset", PROPERTY_HINT_RANGE, "0,65535,1,or_greater"), "set_pixel_offset", "get_pixel_offset");
+
+    ClassDB::bind_method(D_METHOD("set_pixel_count", "count"), &SacnEffectLayer::set_pixel_count);
+    ClassDB::bind_method(D_METHOD("get_pixel_count"), &SacnEffectLayer::get_pixel_count);
+    ClassDB::add_property("SacnEffectLayer", PropertyInfo(Variant::INT, "pixel_count", PROPERTY_HINT_RANGE, "0,65535,1,or_greater"), "set_pixel_count", "get_pixel_count");
+
+    BIND_ENUM_CONSTANT(EFFECT_SOLID);
+    BIND_ENUM_CONSTANT(EFFECT_CHASE);
+    BIND_ENUM_CONSTANT(EFFECT_GRADIENT);
+    BIND_ENUM_CONSTANT(EFFECT_NOISE);
+    BIND_ENUM_CONSTANT(EFFECT_STROBE);
+    BIND_ENUM_CONSTANT(EFFECT_FADE);
+
+    BIND_ENUM_CONSTANT(BLEND_NORMAL);
+    BIND_ENUM_CONSTANT(BLEND_ADD);
+    BIND_ENUM_CONSTANT(BLEND_MULTIPLY);
+    BIND_ENUM_CONSTANT(BLEND_MAX);
+    BIND_ENUM_CONSTANT(BLEND_SUBTRACT);
+}
+
+void SacnEffectLayer::set_enabled(bool p_enabled) {
+    enabled = p_enabled;
+    emit_changed();
+}
+
+bool SacnEffectLayer::is_enabled() const {
+    return enabled;
+}
+
+void SacnEffectLayer::set_effect(EffectType p_effect) {
+    effect = p_effect;
+    emit_changed();
+}
+
+SacnEffectLayer::EffectType SacnEffectLayer::get_effect() const {
+    return effect;
+}
+
+void SacnEffectLayer::set_blend_mode(BlendMode p_mode) {
+    blend_mode = p_mode;
+    emit_changed();
+}
+
+SacnEffectLayer::BlendMode SacnEffectLayer::get_blend_mode() const {
+    return blend_mode;
+}
+
+void SacnEffectLayer::set_opacity(float p_opacity) {
+    opacity = p_opacity;
+    emit_changed();
+}
+
+float SacnEffectLayer::get_opacity() const {
+    return opacity;
+}
+
+void SacnEffectLayer::set_color_a(const Color &p_color) {
+    color_a = p_color;
+    emit_changed();
+}
+
+Color SacnEffectLayer::get_color_a() const {
+    return color_a;
+}
+
+void SacnEffectLayer::set_color_b(const Color &p_color) {
+    color_b = p_color;
+    emit_changed();
+}
+
+Color SacnEffectLayer::get_color_b() const {
+    return color_b;
+}
+
+void SacnEffectLayer::set_speed(float p_speed) {
+    speed = p_speed;
+    emit_changed();
+}
+
+float SacnEffectLayer::get_speed() const {
+    return speed;
+}
+
+void SacnEffectLayer::set_size(float p_size) {
+    size = p_size;
+    emit_changed();
+}
+
+float SacnEffectLayer::get_size() const {
+    return size;
+}
+
+void SacnEffectLayer::set_duty(float p_duty) {
+    duty = p_duty;
+    emit_changed();
+}
+
+float SacnEffectLayer::get_duty() const {
+    return duty;
+}
+
+void SacnEffectLayer::set_seed(int p_seed) {
+    seed = p_seed;
+    emit_changed();
+}
+
+int SacnEffectLayer::get_seed() const {
+    return seed;
+}
+
+void SacnEffectLayer::set_pixel_offset(int p_offset) {
+    pixel_offset = p_offset;
+    emit_changed();
+}
+
+int SacnEffectLayer::get_pixel_offset() const {
+    return pixel_offset;
+}
+
+void SacnEffectLayer::set_pixel_count(int p_count) {
+    pixel_count = p_count;
+    emit_changed();
+}
+
+int SacnEffectLayer::get_pixel_count() const {
+    return pixel_count;
+}
+
+gacn::EffectParams SacnEffectLayer::get_params() const {
+    gacn::EffectParams params;
+    params.type = (gacn::EffectType)effect;
+    params.blend = (gacn::BlendMode)blend_mode;
+    params.opacity = enabled ? opacity : 0.0f;
+    params.color_a[0] = color_a.r;
+    params.color_a[1] = color_a.g;
+    params.color_a[2] = color_a.b;
+    params.color_b[0] = color_b.r;
+    params.color_b[1] = color_b.g;
+    params.color_b[2] = color_b.b;
+    params.speed = speed;
+    params.size = size;
+    params.duty = duty;
+    params.seed = (uint32_t)seed;
+    params.pixel_offset = pixel_offset;
+    params.pixel_count = pixel_count;
+    return params;
+}
+
+}
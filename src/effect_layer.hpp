@@ -0,0 +1,97 @@
+#ifndef EFFECT_LAYER_HPP
+#define EFFECT_LAYER_HPP
+
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/color.hpp>
+
+#include "effect_kernels.hpp"
+
+namespace godot {
+
+// One generative layer evaluated natively by SacnEffectEngine. All parameters
+// are plain properties, so they can be keyed in an AnimationPlayer.
+class SacnEffectLayer : public Resource {
+    GDCLASS(SacnEffectLayer, Resource);
+
+public:
+    enum EffectType {
+        EFFECT_SOLID = gacn::EFFECT_SOLID,
+        EFFECT_CHASE = gacn::EFFECT_CHASE,
+        EFFECT_GRADIENT = gacn::EFFECT_GRADIENT,
+        EFFECT_NOISE = gacn::EFFECT_NOISE,
+        EFFECT_STROBE = gacn::EFFECT_STROBE,
+        EFFECT_FADE = gacn::EFFECT_FADE,
+    };
+
+    enum BlendMode {
+        BLEND_NORMAL = gacn::BLEND_NORMAL,
+        BLEND_ADD = gacn::BLEND_ADD,
+        BLEND_MULTIPLY = gacn::BLEND_MULTIPLY,
+        BLEND_MAX = gacn::BLEND_MAX,
+        BLEND_SUBTRACT = gacn::BLEND_SUBTRACT,
+    };
+
+private:
+    bool enabled = true;
+    EffectType effect = EFFECT_SOLID;
+    BlendMode blend_mode = BLEND_NORMAL;
+    float opacity = 1.0;
+    Color color_a = Color(1, 1, 1);
+    Color color_b = Color(0, 0, 0);
+    float speed = 1.0;
+    float size = 10.0;
+    float duty = 0.5;
+    int seed = 0;
+    int pixel_offset = 0;
+    int pixel_count = 0;
+
+protected:
+    static void _bind_methods();
+
+public:
+    void set_enabled(bool p_enabled);
+    bool is_enabled() const;
+
+    void set_effect(EffectType p_effect);
+    EffectType get_effect() const;
+
+    void set_blend_mode(BlendMode p_mode);
+    BlendMode get_blend_mode() const;
+
+    void set_opacity(float p_opacity);
+    float get_opacity() const;
+
+    void set_color_a(const Color &p_color);
+    Color get_color_a() const;
+
+    void set_color_b(const Color &p_color);
+    Color get_color_b() const;
+
+    void set_speed(float p_speed);
+    float get_speed() const;
+
+    void set_size(float p_size);
+    float get_size() const;
+
+    void set_duty(float p_duty);
+    float get_duty() const;
+
+    void set_seed(int p_seed);
+    int get_seed() const;
+
+    void set_pixel_offset(int p_offset);
+    int get_pixel_offset() const;
+
+    void set_pixel_count(int p_count);
+    int get_pixel_count() const;
+
+    gacn::EffectParams get_params() const;
+};
+
+}
+
+VARIANT_ENUM_CAST(SacnEffectLayer::EffectType);
+VARIANT_ENUM_CAST(SacnEffectLayer::BlendMode);
+
+#endif
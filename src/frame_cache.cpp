@@ -0,0 +1,169 @@
+#include "frame_cache.hpp"
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace godot {
+
+void SacnFrameCache::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_data", "data"), &SacnFrameCache::set_data);
+    ClassDB::bind_method(D_METHOD("get_data"), &SacnFrameCache::get_data);
+    ClassDB::add_property("SacnFrameCache", PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE), "set_data", "get_data");
+
+    ClassDB::bind_method(D_METHOD("get_universes"), &SacnFrameCache::get_universes);
+    ClassDB::bind_method(D_METHOD("get_fps"), &SacnFrameCache::get_fps);
+    ClassDB::bind_method(D_METHOD("get_keyframe_interval"), &SacnFrameCache::get_keyframe_interval);
+    ClassDB::bind_method(D_METHOD("get_frame_count"), &SacnFrameCache::get_frame_count);
+    ClassDB::bind_method(D_METHOD("get_duration"), &SacnFrameCache::get_duration);
+    ClassDB::bind_method(D_METHOD("get_encoded_size"), &SacnFrameCache::get_encoded_size);
+
+    ClassDB::bind_method(D_METHOD("begin_bake", "universes", "fps", "keyframe_interval"), &SacnFrameCache::begin_bake, DEFVAL(44.0), DEFVAL(44));
+    ClassDB::bind_method(D_METHOD("add_frame", "frame"), &SacnFrameCache::add_frame);
+    ClassDB::bind_method(D_METHOD("end_bake"), &SacnFrameCache::end_bake);
+    ClassDB::bind_method(D_METHOD("bake", "renderer", "universes", "duration", "fps", "keyframe_interval"), &SacnFrameCache::bake, DEFVAL(44.0), DEFVAL(44));
+    ClassDB::bind_method(D_METHOD("get_frame", "frame"), &SacnFrameCache::get_frame);
+}
+
+void SacnFrameCache::set_data(const PackedByteArray &p_data) {
+    if (p_data.size() == 0) {
+        cache.clear();
+    } else if (!cache.deserialize(p_data.ptr(), p_data.size())) {
+        UtilityFunctions::printerr("SacnFrameCache: data is not a valid frame cache");
+        cache.clear();
+    }
+    baking = false;
+    version++;
+    emit_changed();
+}
+
+PackedByteArray SacnFrameCache::get_data() const {
+    PackedByteArray result;
+    if (cache.get_frame_count() == 0) {
+        return result;
+    }
+    std::vector<uint8_t> bytes;
+    cache.serialize(bytes);
+    result.resize(bytes.size());
+    std::copy(bytes.begin(), bytes.end(), result.ptrw());
+    return result;
+}
+
+PackedInt32Array SacnFrameCache::get_universes() const {
+    PackedInt32Array result;
+    for (uint16_t universe : cache.get_universes()) {
+        result.push_back(universe);
+    }
+    return result;
+}
+
+double SacnFrameCache::get_fps() const {
+    return cache.get_fps();
+}
+
+int SacnFrameCache::get_keyframe_interval() const {
+    return cache.get_keyframe_interval();
+}
+
+int SacnFrameCache::get_frame_count() const {
+    return cache.get_frame_count();
+}
+
+double SacnFrameCache::get_duration() const {
+    return cache.get_frame_count() / cache.get_fps();
+}
+
+int64_t SacnFrameCache::get_encoded_size() const {
+    return (int64_t)cache.get_encoded_size();
+}
+
+void SacnFrameCache::begin_bake(const PackedInt32Array &p_universes, double p_fps, int p_keyframe_interval) {
+    std::vector<uint16_t> universes;
+    for (int64_t i = 0; i < p_universes.size(); ++i) {
+        const int32_t universe = p_universes[i];
+        if (universe < 1 || universe > 63999) {
+            UtilityFunctions::printerr("SacnFrameCache: invalid universe ", universe);
+            return;
+        }
+        universes.push_back((uint16_t)universe);
+    }
+    if (!(p_fps > 0.0)) {
+        UtilityFunctions::printerr("SacnFrameCache: fps must be positive");
+        return;
+    }
+    cache.begin(universes, p_fps, p_keyframe_interval);
+    bake_lengths.assign(universes.size(), 512);
+    baking = true;
+    version++;
+}
+
+void SacnFrameCache::add_frame(const PackedByteArray &p_frame) {
+    if (!baking) {
+        UtilityFunctions::printerr("SacnFrameCache: add_frame() outside begin_bake()/end_bake()");
+        return;
+    }
+    const int64_t expected = (int64_t)cache.get_universes().size() * 512;
+    if (p_frame.size() != expected) {
+        UtilityFunctions::printerr("SacnFrameCache: frame must hold ", expected, " bytes, got ", p_frame.size());
+        return;
+    }
+    cache.append(p_frame.ptr(), 512, bake_lengths.data());
+    version++;
+}
+
+void SacnFrameCache::end_bake() {
+    baking = false;
+    emit_changed();
+}
+
+bool SacnFrameCache::bake(const Callable &p_renderer, const PackedInt32Array &p_universes, double p_duration, double p_fps, int p_keyframe_interval) {
+    if (!p_renderer.is_valid() || !(p_duration > 0.0)) {
+        UtilityFunctions::printerr("SacnFrameCache: bake needs a valid renderer and a positive duration");
+        return false;
+    }
+    begin_bake(p_universes, p_fps, p_keyframe_interval);
+    if (!baking) {
+        return false;
+    }
+    const int frames = (int)std::ceil(p_duration * p_fps);
+    for (int frame = 0; frame < frames; ++frame) {
+        PackedByteArray data = p_renderer.call(frame / p_fps);
+        const int before = cache.get_frame_count();
+        add_frame(data);
+        if (cache.get_frame_count() == before) {
+            // add_frame() already said why.
+            baking = false;
+            return false;
+        }
+    }
+    end_bake();
+    return true;
+}
+
+PackedByteArray SacnFrameCache::get_frame(int p_frame) const {
+    PackedByteArray result;
+    gacn::FrameCacheCursor cursor;
+    cursor.reset(&cache);
+    if (!cursor.seek(p_frame)) {
+        return result;
+    }
+    const int count = (int)cache.get_universes().size();
+    result.resize((int64_t)count * 512);
+    uint8_t *out = result.ptrw();
+    std::fill(out, out + (size_t)count * 512, 0);
+    for (int i = 0; i < count; ++i) {
+        std::copy(cursor.get_data(i), cursor.get_data(i) + cursor.get_length(i), out + (size_t)i * 512);
+    }
+    return result;
+}
+
+const gacn::FrameCache &SacnFrameCache::get_cache() const {
+    return cache;
+}
+
+uint64_t SacnFrameCache::get_version() const {
+    return version;
+}
+
+}
@@ -0,0 +1,63 @@
+#ifndef FRAME_CACHE_HPP
+#define FRAME_CACHE_HPP
+
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/callable.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+
+#include "frame_codec.hpp"
+
+#include <vector>
+
+namespace godot {
+
+// A timeline baked into delta-encoded DMX frames, played back by
+// SacnCachePlayer without evaluating the scene. Frames are passed in and out
+// as 512 bytes per universe, in the order of `universes`. Save it like any
+// other resource; the encoded frames are stored in `data`.
+class SacnFrameCache : public Resource {
+    GDCLASS(SacnFrameCache, Resource);
+
+private:
+    gacn::FrameCache cache;
+    uint64_t version = 0;
+    bool baking = false;
+    std::vector<uint16_t> bake_lengths;
+
+protected:
+    static void _bind_methods();
+
+public:
+    void set_data(const PackedByteArray &p_data);
+    PackedByteArray get_data() const;
+
+    PackedInt32Array get_universes() const;
+    double get_fps() const;
+    int get_keyframe_interval() const;
+    int get_frame_count() const;
+    double get_duration() const;
+    int64_t get_encoded_size() const;
+
+    // Incremental bake, for frames from any source (a script stepping an
+    // AnimationPlayer, a recording of SacnReceiver.frame_received, ...).
+    void begin_bake(const PackedInt32Array &p_universes, double p_fps, int p_keyframe_interval);
+    void add_frame(const PackedByteArray &p_frame);
+    void end_bake();
+    // Calls renderer(time) for every frame of the timeline; it must return
+    // one frame as above.
+    bool bake(const Callable &p_renderer, const PackedInt32Array &p_universes, double p_duration, double p_fps, int p_keyframe_interval);
+
+    // Decodes one frame, mostly for inspection.
+    PackedByteArray get_frame(int p_frame) const;
+
+    // Native access for SacnCachePlayer; the version changes whenever the
+    // frames do.
+    const gacn::FrameCache &get_cache() const;
+    uint64_t get_version() const;
+};
+
+}
+
+#endif
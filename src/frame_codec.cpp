@@ -0,0 +1,297 @@
+#include "frame_codec.hpp"
+
+#include "slot_diff.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gacn {
+
+static void write_varint(std::vector<uint8_t> &out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static bool read_varint(const uint8_t *data, size_t end, size_t &pos, uint32_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= end) {
+            return false;
+        }
+        const uint8_t byte = data[pos++];
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void write_u32(std::vector<uint8_t> &out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back((uint8_t)(value >> (8 * i)));
+    }
+}
+
+static bool read_u32(const uint8_t *data, size_t size, size_t &pos, uint32_t &value) {
+    if (pos > size || size - pos < 4) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= (uint32_t)data[pos++] << (8 * i);
+    }
+    return true;
+}
+
+FrameCache::FrameCache() {
+}
+
+void FrameCache::begin(const std::vector<uint16_t> &p_universes, double p_fps, int p_keyframe_interval) {
+    universes = p_universes;
+    fps = std::max(0.001, p_fps);
+    keyframe_interval = std::max(1, p_keyframe_interval);
+    offsets.clear();
+    data.clear();
+    previous.assign(universes.size() * 512, 0);
+    previous_lengths.assign(universes.size(), 0);
+}
+
+void FrameCache::clear() {
+    begin(std::vector<uint16_t>(), fps, keyframe_interval);
+}
+
+void FrameCache::append(const uint8_t *frame, size_t stride, const uint16_t *lengths) {
+    if (previous.size() != universes.size() * 512) {
+        return; // not started with begin()
+    }
+    const bool keyframe = offsets.size() % (size_t)keyframe_interval == 0;
+    offsets.push_back((uint32_t)data.size());
+
+    // The changed count leads the record, so count first.
+    const size_t count_pos = data.size();
+    uint32_t changed = 0;
+    std::vector<uint8_t> body;
+    body.reserve(keyframe ? universes.size() * 520 : 64);
+
+    for (size_t i = 0; i < universes.size(); ++i) {
+        const uint8_t *current = frame + i * stride;
+        const uint16_t length = std::min<uint16_t>(lengths[i], 512);
+        uint8_t *last = &previous[i * 512];
+
+        ranges.clear();
+        if (keyframe) {
+            if (length > 0) {
+                ranges.push_back(0);
+                ranges.push_back(length);
+            }
+        } else {
+            SlotMask mask;
+            if (diff_slots(last, previous_lengths[i], current, length, mask) == 0 && length == previous_lengths[i]) {
+                continue;
+            }
+            mask_to_ranges(mask, ranges);
+
+            // Clip to the new length and bridge short unchanged gaps, which
+            // cost more as span headers than as repeated bytes.
+            size_t merged = 0;
+            for (size_t r = 0; r < ranges.size(); r += 2) {
+                int32_t start = ranges[r];
+                int32_t end = std::min<int32_t>(ranges[r] + ranges[r + 1], length);
+                if (start >= end) {
+                    continue;
+                }
+                if (merged > 0 && start - (ranges[merged - 2] + ranges[merged - 1]) <= MERGE_GAP) {
+                    ranges[merged - 1] = end - ranges[merged - 2];
+                } else {
+                    ranges[merged++] = start;
+                    ranges[merged++] = end - start;
+                }
+            }
+            ranges.resize(merged);
+        }
+
+        write_varint(body, (uint32_t)i);
+        write_varint(body, length);
+        write_varint(body, (uint32_t)(ranges.size() / 2));
+        int32_t end = 0;
+        for (size_t r = 0; r < ranges.size(); r += 2) {
+            write_varint(body, (uint32_t)(ranges[r] - end));
+            write_varint(body, (uint32_t)ranges[r + 1]);
+            body.insert(body.end(), current + ranges[r], current + ranges[r] + ranges[r + 1]);
+            end = ranges[r] + ranges[r + 1];
+        }
+        changed++;
+
+        std::memcpy(last, current, length);
+        previous_lengths[i] = length;
+    }
+
+    data.resize(count_pos);
+    write_varint(data, changed);
+    data.insert(data.end(), body.begin(), body.end());
+}
+
+const std::vector<uint16_t> &FrameCache::get_universes() const {
+    return universes;
+}
+
+double FrameCache::get_fps() const {
+    return fps;
+}
+
+int FrameCache::get_keyframe_interval() const {
+    return keyframe_interval;
+}
+
+int FrameCache::get_frame_count() const {
+    return (int)offsets.size();
+}
+
+size_t FrameCache::get_encoded_size() const {
+    return data.size() + offsets.size() * 4 + universes.size() * 2;
+}
+
+void FrameCache::serialize(std::vector<uint8_t> &out) const {
+    out.clear();
+    out.reserve(32 + universes.size() * 2 + offsets.size() * 4 + data.size());
+    write_u32(out, MAGIC);
+    write_u32(out, FORMAT_VERSION);
+    write_u32(out, (uint32_t)std::lround(fps * 1000.0)); // millihertz
+    write_u32(out, (uint32_t)keyframe_interval);
+    write_u32(out, (uint32_t)universes.size());
+    write_u32(out, (uint32_t)offsets.size());
+    write_u32(out, (uint32_t)data.size());
+    for (uint16_t universe : universes) {
+        out.push_back((uint8_t)universe);
+        out.push_back((uint8_t)(universe >> 8));
+    }
+    for (uint32_t offset : offsets) {
+        write_u32(out, offset);
+    }
+    out.insert(out.end(), data.begin(), data.end());
+}
+
+bool FrameCache::deserialize(const uint8_t *bytes, size_t size) {
+    size_t pos = 0;
+    uint32_t magic, version, millihertz, interval, universe_count, frame_count, data_size;
+    if (!read_u32(bytes, size, pos, magic) || magic != MAGIC ||
+            !read_u32(bytes, size, pos, version) || version != FORMAT_VERSION ||
+            !read_u32(bytes, size, pos, millihertz) || millihertz == 0 ||
+            !read_u32(bytes, size, pos, interval) || interval == 0 ||
+            !read_u32(bytes, size, pos, universe_count) || universe_count > 64000 ||
+            !read_u32(bytes, size, pos, frame_count) ||
+            !read_u32(bytes, size, pos, data_size)) {
+        return false;
+    }
+    const uint64_t needed = (uint64_t)universe_count * 2 + (uint64_t)frame_count * 4 + data_size;
+    if (needed != size - pos) {
+        return false;
+    }
+
+    std::vector<uint16_t> new_universes(universe_count);
+    for (uint32_t i = 0; i < universe_count; ++i) {
+        new_universes[i] = (uint16_t)(bytes[pos] | (bytes[pos + 1] << 8));
+        pos += 2;
+    }
+    std::vector<uint32_t> new_offsets(frame_count);
+    for (uint32_t i = 0; i < frame_count; ++i) {
+        read_u32(bytes, size, pos, new_offsets[i]);
+        if (new_offsets[i] >= data_size || (i > 0 && new_offsets[i] <= new_offsets[i - 1])) {
+            return false;
+        }
+    }
+
+    begin(new_universes, millihertz / 1000.0, (int)interval);
+    offsets.swap(new_offsets);
+    data.assign(bytes + pos, bytes + size);
+    // Appending after a load would need the last frame decoded; start over instead.
+    previous.clear();
+    previous_lengths.clear();
+    return true;
+}
+
+void FrameCacheCursor::reset(const FrameCache *p_cache) {
+    cache = p_cache;
+    frame = -1;
+    const size_t count = cache != nullptr ? cache->universes.size() : 0;
+    buffers.assign(count * 512, 0);
+    lengths.assign(count, 0);
+}
+
+bool FrameCacheCursor::seek(int target) {
+    if (cache == nullptr || target < 0 || target >= cache->get_frame_count()) {
+        return false;
+    }
+    if (target == frame) {
+        return true;
+    }
+    const int keyframe = target - target % cache->keyframe_interval;
+    int next = frame >= keyframe && frame < target ? frame + 1 : keyframe;
+    if (next == keyframe) {
+        std::fill(lengths.begin(), lengths.end(), 0);
+    }
+    for (; next <= target; ++next) {
+        if (!_apply(next)) {
+            frame = -1;
+            return false;
+        }
+    }
+    frame = target;
+    return true;
+}
+
+int FrameCacheCursor::get_frame() const {
+    return frame;
+}
+
+const uint8_t *FrameCacheCursor::get_data(int index) const {
+    return &buffers[(size_t)index * 512];
+}
+
+uint16_t FrameCacheCursor::get_length(int index) const {
+    return lengths[index];
+}
+
+bool FrameCacheCursor::_apply(int record) {
+    const std::vector<uint8_t> &data = cache->data;
+    const size_t end = (size_t)record + 1 < cache->offsets.size() ? cache->offsets[record + 1] : data.size();
+    size_t pos = cache->offsets[record];
+    const uint32_t universe_count = (uint32_t)lengths.size();
+
+    uint32_t changed;
+    if (!read_varint(data.data(), end, pos, changed)) {
+        return false;
+    }
+    for (uint32_t c = 0; c < changed; ++c) {
+        uint32_t index, length, spans;
+        if (!read_varint(data.data(), end, pos, index) || index >= universe_count ||
+                !read_varint(data.data(), end, pos, length) || length > 512 ||
+                !read_varint(data.data(), end, pos, spans)) {
+            return false;
+        }
+        uint8_t *buffer = &buffers[(size_t)index * 512];
+        uint32_t span_end = 0;
+        for (uint32_t s = 0; s < spans; ++s) {
+            uint32_t gap, span_length;
+            if (!read_varint(data.data(), end, pos, gap) || !read_varint(data.data(), end, pos, span_length)) {
+                return false;
+            }
+            const uint32_t start = span_end + gap;
+            if (start > length || span_length > length - start || span_length > end - pos) {
+                return false;
+            }
+            std::memcpy(buffer + start, &data[pos], span_length);
+            pos += span_length;
+            span_end = start + span_length;
+        }
+        lengths[index] = (uint16_t)length;
+    }
+    return pos == end;
+}
+
+}
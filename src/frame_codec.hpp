@@ -0,0 +1,88 @@
+#ifndef FRAME_CODEC_HPP
+#define FRAME_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gacn {
+
+// A baked timeline: a fixed list of universes sampled at a fixed frame rate.
+// Every keyframe_interval-th frame stores all universes in full; the frames in
+// between store only the slot spans that changed since the previous frame, so
+// a static look costs one byte per frame. Seeking decodes from the nearest
+// keyframe forward.
+//
+// Frame record, all numbers LEB128 varints:
+//     changed universe count, then per universe:
+//         universe index, slot count, span count, then per span:
+//             gap since the previous span's end, span length, slot bytes
+class FrameCache {
+public:
+    static const uint32_t MAGIC = 0x63666367; // "gcfc"
+    static const uint32_t FORMAT_VERSION = 1;
+    // Unchanged slots bridged inside one span rather than starting a new one.
+    static const int MERGE_GAP = 4;
+
+    FrameCache();
+
+    // Encoding. begin() discards the current contents; append() takes one
+    // frame as universes.size() blocks of `stride` bytes, with the slot count
+    // of every universe in `lengths`.
+    void begin(const std::vector<uint16_t> &p_universes, double p_fps, int p_keyframe_interval);
+    void append(const uint8_t *frame, size_t stride, const uint16_t *lengths);
+    void clear();
+
+    const std::vector<uint16_t> &get_universes() const;
+    double get_fps() const;
+    int get_keyframe_interval() const;
+    int get_frame_count() const;
+    size_t get_encoded_size() const;
+
+    // Self-contained byte image, little endian. deserialize() validates the
+    // header and index; frame records are checked while decoding.
+    void serialize(std::vector<uint8_t> &out) const;
+    bool deserialize(const uint8_t *bytes, size_t size);
+
+private:
+    friend class FrameCacheCursor;
+
+    std::vector<uint16_t> universes;
+    double fps = 44.0;
+    int keyframe_interval = 44;
+    std::vector<uint32_t> offsets; // start of every frame record in data
+    std::vector<uint8_t> data;
+
+    // Encoder state: the previous frame.
+    std::vector<uint8_t> previous;
+    std::vector<uint16_t> previous_lengths;
+    std::vector<int32_t> ranges;
+};
+
+// Decodes a FrameCache into full universe buffers. Moving forward within a
+// keyframe group applies only the deltas in between; anything else restarts
+// from the keyframe at or before the target.
+class FrameCacheCursor {
+public:
+    void reset(const FrameCache *p_cache);
+
+    // Returns false if the frame is out of range or its record is damaged.
+    bool seek(int frame);
+    int get_frame() const;
+
+    // Universe i of the cache, in get_universes() order.
+    const uint8_t *get_data(int index) const;
+    uint16_t get_length(int index) const;
+
+private:
+    const FrameCache *cache = nullptr;
+    int frame = -1;
+    std::vector<uint8_t> buffers; // 512 bytes per universe
+    std::vector<uint16_t> lengths;
+
+    bool _apply(int record);
+};
+
+}
+
+#endif
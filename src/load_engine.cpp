@@ -0,0 +1,338 @@
+#include "load_engine.hpp"
+
+#include "sacn_log.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace gacn {
+
+namespace load_pattern {
+
+static uint8_t pattern_byte(uint8_t source, uint16_t universe, uint32_t frame, uint16_t slot) {
+    return (uint8_t)(frame * 3u + universe + slot + source * 31u);
+}
+
+void fill(uint8_t *data, uint16_t length, uint8_t source, uint16_t universe, uint32_t frame, uint64_t time_ns) {
+    uint8_t marker[MARKER_SIZE];
+    marker[0] = 'g';
+    marker[1] = 'L';
+    marker[2] = source;
+    marker[3] = 0;
+    for (int i = 0; i < 4; ++i) {
+        marker[4 + i] = (uint8_t)(frame >> (8 * i));
+    }
+    for (int i = 0; i < 8; ++i) {
+        marker[8 + i] = (uint8_t)(time_ns >> (8 * i));
+    }
+    const uint16_t marker_length = std::min(length, MARKER_SIZE);
+    std::memcpy(data, marker, marker_length);
+    for (uint16_t slot = marker_length; slot < length; ++slot) {
+        data[slot] = pattern_byte(source, universe, frame, slot);
+    }
+}
+
+bool parse(const uint8_t *data, uint16_t length, uint16_t universe, uint8_t &source, uint32_t &frame, uint64_t &time_ns) {
+    if (length < MARKER_SIZE || data[0] != 'g' || data[1] != 'L' || data[3] != 0) {
+        return false;
+    }
+    source = data[2];
+    frame = 0;
+    for (int i = 0; i < 4; ++i) {
+        frame |= (uint32_t)data[4 + i] << (8 * i);
+    }
+    time_ns = 0;
+    for (int i = 0; i < 8; ++i) {
+        time_ns |= (uint64_t)data[8 + i] << (8 * i);
+    }
+    for (uint16_t slot = MARKER_SIZE; slot < length; ++slot) {
+        if (data[slot] != pattern_byte(source, universe, frame, slot)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+LoadGenerator::LoadGenerator() {
+}
+
+LoadGenerator::~LoadGenerator() {
+    stop();
+}
+
+bool LoadGenerator::start(const Config &p_config) {
+    if (running.load()) {
+        return true;
+    }
+    config = p_config;
+    config.universe_count = std::max(1, std::min(config.universe_count, (int)SenderEngine::MAX_UNIVERSE + 1 - config.first_universe));
+    config.rate_hz = std::max(0.1, std::min(config.rate_hz, 10000.0));
+    config.slots = std::max<uint16_t>(load_pattern::MARKER_SIZE, std::min<uint16_t>(config.slots, 512));
+    config.sources = std::max(1, std::min(config.sources, MAX_SOURCES));
+    if (config.first_universe < 1) {
+        log_error("LoadGenerator: first universe must be at least 1");
+        return false;
+    }
+
+    engines.clear();
+    for (int i = 0; i < config.sources; ++i) {
+        std::unique_ptr<SenderEngine> engine(new SenderEngine());
+        char name[64];
+        std::snprintf(name, sizeof(name), "gacn load generator %d", i);
+        engine->set_source_name(name);
+        engine->set_worker_count(config.worker_count);
+        engine->set_latency_tuning(config.tuning);
+        SenderEngine::Impairment impairment = config.impairment;
+        impairment.seed += (uint64_t)i * 0x632be59bd9b4e019ull;
+        engine->set_impairment(impairment);
+        if (!engine->start(config.queue_capacity)) {
+            engines.clear();
+            return false;
+        }
+        engines.push_back(std::move(engine));
+    }
+
+    ticks = 0;
+    late_ticks = 0;
+    submitted = 0;
+    start_ns = monotonic_ns();
+    stop_ns = 0;
+    running = true;
+    thread = std::thread(&LoadGenerator::_thread_func, this);
+    log_info("LoadGenerator: %d universes from %u at %.1f Hz, %d source(s)",
+            config.universe_count, config.first_universe, config.rate_hz, config.sources);
+    return true;
+}
+
+void LoadGenerator::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    stop_ns = monotonic_ns();
+    // Counters stay readable; the engines drain and join here.
+    for (std::unique_ptr<SenderEngine> &engine : engines) {
+        engine->stop();
+    }
+}
+
+bool LoadGenerator::is_running() const {
+    return running.load();
+}
+
+LoadGenerator::Report LoadGenerator::get_report() const {
+    Report report;
+    const uint64_t end_ns = stop_ns != 0 ? stop_ns : monotonic_ns();
+    report.elapsed = start_ns != 0 ? (double)(end_ns - start_ns) * 1e-9 : 0.0;
+    report.ticks = ticks.load(std::memory_order_relaxed);
+    report.late_ticks = late_ticks.load(std::memory_order_relaxed);
+    report.submitted = submitted.load(std::memory_order_relaxed);
+    for (const std::unique_ptr<SenderEngine> &engine : engines) {
+        report.queue_drops += engine->get_dropped_count();
+        report.sent += engine->get_sent_count();
+        report.impaired_lost += engine->get_impaired_lost_count();
+        report.impaired_reordered += engine->get_impaired_reordered_count();
+    }
+    return report;
+}
+
+uint32_t LoadGenerator::get_denied_tuning() const {
+    uint32_t denied = 0;
+    for (const std::unique_ptr<SenderEngine> &engine : engines) {
+        denied |= engine->get_denied_tuning();
+    }
+    return denied;
+}
+
+void LoadGenerator::_thread_func() {
+    const uint64_t period_ns = (uint64_t)(1e9 / config.rate_hz);
+    uint64_t next_ns = monotonic_ns();
+    uint32_t frame = 0;
+
+    while (running.load(std::memory_order_relaxed)) {
+        uint64_t now = monotonic_ns();
+        if (now < next_ns) {
+            // Short naps so stop() is never held up by a slow rate.
+            std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<uint64_t>(next_ns - now, 50000000ull)));
+            continue;
+        }
+        if (now - next_ns > period_ns) {
+            // Fell a whole period behind: count it and restart the schedule
+            // instead of bursting to catch up.
+            late_ticks.fetch_add(1, std::memory_order_relaxed);
+            next_ns = now;
+        }
+
+        uint64_t count = 0;
+        for (int source = 0; source < config.sources; ++source) {
+            SenderEngine &engine = *engines[source];
+            for (int i = 0; i < config.universe_count; ++i) {
+                const uint16_t universe = (uint16_t)(config.first_universe + i);
+                engine.submit_with(universe, config.slots, config.target, [&](uint8_t *data) {
+                    load_pattern::fill(data, config.slots, (uint8_t)source, universe, frame, monotonic_ns());
+                });
+                count++;
+            }
+        }
+        submitted.fetch_add(count, std::memory_order_relaxed);
+        ticks.fetch_add(1, std::memory_order_relaxed);
+        frame++;
+        next_ns += period_ns;
+    }
+}
+
+LoadAnalyzer::LoadAnalyzer() {
+    histogram.assign(LATENCY_BUCKETS, 0);
+}
+
+void LoadAnalyzer::configure(uint16_t p_first_universe, int p_universe_count, int p_sources) {
+    std::lock_guard<std::mutex> lock(mtx);
+    first_universe = p_first_universe;
+    universe_count = std::max(0, p_universe_count);
+    sources = std::max(1, std::min(p_sources, LoadGenerator::MAX_SOURCES));
+    streams.assign((size_t)sources * universe_count, Stream());
+    std::fill(histogram.begin(), histogram.end(), 0);
+    totals = Report();
+    first_ns = 0;
+    last_ns = 0;
+}
+
+void LoadAnalyzer::reset() {
+    configure(first_universe, universe_count, sources);
+}
+
+void LoadAnalyzer::attach(ReceiverEngine &receiver) {
+    receiver.set_packet_tap([this](const e131_packet_t &packet, size_t length, const e131_addr_t &, const e131_addr_t &, bool discarded) {
+        record(packet, length, discarded, monotonic_ns());
+    });
+}
+
+int LoadAnalyzer::latency_bucket(uint64_t ns) {
+    if (ns < 8) {
+        return (int)ns;
+    }
+    const int exponent = 63 - __builtin_clzll(ns);
+    const int sub = (int)((ns >> (exponent - 3)) & 7);
+    return (exponent - 2) * 8 + sub;
+}
+
+uint64_t LoadAnalyzer::latency_bucket_limit(int bucket) {
+    if (bucket < 8) {
+        return (uint64_t)bucket;
+    }
+    const int exponent = bucket / 8 + 2;
+    const uint64_t sub = (uint64_t)(bucket % 8);
+    if (exponent >= 63 && sub == 7) {
+        return UINT64_MAX;
+    }
+    return ((8 + sub + 1) << (exponent - 3)) - 1;
+}
+
+void LoadAnalyzer::record(const e131_packet_t &packet, size_t length, bool discarded, uint64_t now_ns) {
+    (void)length;
+    const uint16_t universe = ntohs(packet.frame.universe);
+    uint16_t slot_count = ntohs(packet.dmp.prop_val_cnt);
+    slot_count = slot_count > 0 ? slot_count - 1 : 0;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (packet.dmp.prop_val[0] != 0x00 || slot_count < load_pattern::MARKER_SIZE || packet.dmp.prop_val[1] != 'g' || packet.dmp.prop_val[2] != 'L') {
+        totals.foreign++;
+        return;
+    }
+    uint8_t source;
+    uint32_t frame;
+    uint64_t time_ns;
+    if (!load_pattern::parse(&packet.dmp.prop_val[1], slot_count, universe, source, frame, time_ns)) {
+        totals.corrupt++;
+        return;
+    }
+    if (source >= sources || universe < first_universe || universe >= first_universe + universe_count) {
+        totals.foreign++;
+        return;
+    }
+
+    if (first_ns == 0) {
+        first_ns = now_ns;
+    }
+    last_ns = now_ns;
+    totals.packets++;
+    totals.bytes += slot_count;
+
+    Stream &stream = streams[(size_t)source * universe_count + (universe - first_universe)];
+    const bool in_order = (int64_t)frame > stream.last_frame;
+    if (in_order) {
+        if (stream.last_frame >= 0) {
+            totals.lost += (uint64_t)((int64_t)frame - stream.last_frame - 1);
+        }
+        stream.last_frame = frame;
+    } else if ((int64_t)frame == stream.last_frame) {
+        totals.duplicates++;
+    } else {
+        totals.late++;
+        // It was counted as a gap when the newer frame arrived.
+        if (totals.lost > 0) {
+            totals.lost--;
+        }
+    }
+
+    // E1.31 receivers should drop anything that is not newer than what they
+    // already have.
+    if (!in_order && discarded) {
+        totals.detected++;
+    } else if (!in_order) {
+        totals.missed++;
+    } else if (discarded) {
+        totals.false_alarms++;
+    }
+
+    const uint64_t latency = now_ns > time_ns ? now_ns - time_ns : 0;
+    histogram[latency_bucket(latency)]++;
+    if (totals.packets == 1 || latency < totals.latency_min) {
+        totals.latency_min = latency;
+    }
+    totals.latency_max = std::max(totals.latency_max, latency);
+}
+
+LoadAnalyzer::Report LoadAnalyzer::get_report() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    Report report = totals;
+    report.latency_histogram = histogram;
+    report.elapsed = last_ns > first_ns ? (double)(last_ns - first_ns) * 1e-9 : 0.0;
+    if (report.elapsed > 0.0) {
+        report.packet_rate = (double)report.packets / report.elapsed;
+    }
+    const uint64_t unique = report.packets - report.duplicates;
+    if (unique + report.lost > 0) {
+        report.loss_ratio = (double)report.lost / (double)(unique + report.lost);
+    }
+    if (report.packets > 0) {
+        report.detection_accuracy = 1.0 - (double)(report.missed + report.false_alarms) / (double)report.packets;
+    }
+
+    const uint64_t thresholds[4] = {
+        (report.packets * 50 + 99) / 100,
+        (report.packets * 90 + 99) / 100,
+        (report.packets * 99 + 99) / 100,
+        (report.packets * 999 + 999) / 1000,
+    };
+    uint64_t *targets[4] = { &report.latency_p50, &report.latency_p90, &report.latency_p99, &report.latency_p999 };
+    uint64_t cumulative = 0;
+    int next = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS && next < 4; ++bucket) {
+        cumulative += histogram[bucket];
+        while (next < 4 && thresholds[next] > 0 && cumulative >= thresholds[next]) {
+            *targets[next] = std::min(latency_bucket_limit(bucket), report.latency_max);
+            next++;
+        }
+    }
+    return report;
+}
+
+}
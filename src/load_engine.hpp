@@ -0,0 +1,164 @@
+#ifndef LOAD_ENGINE_HPP
+#define LOAD_ENGINE_HPP
+
+#include "e131.h"
+#include "receiver_engine.hpp"
+#include "sender_engine.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gacn {
+
+// Payload layout of a generated universe. The first MARKER_SIZE slots carry a
+// marker; the rest is a pattern derived from the marker, so the analyzer can
+// check every byte without knowing what was sent.
+//
+//     0-1   'g' 'L'
+//     2     source index
+//     3     0
+//     4-7   frame number, little endian, one per tick
+//     8-15  monotonic send time in ns, little endian
+namespace load_pattern {
+
+static const uint16_t MARKER_SIZE = 16;
+
+void fill(uint8_t *data, uint16_t length, uint8_t source, uint16_t universe, uint32_t frame, uint64_t time_ns);
+// Returns false if the payload carries no marker or its pattern is damaged.
+bool parse(const uint8_t *data, uint16_t length, uint16_t universe, uint8_t &source, uint32_t &frame, uint64_t &time_ns);
+
+}
+
+// Pushes universe_count universes at rate_hz from one or more sources, each a
+// SenderEngine with its own CID. Impairments are applied by the engines after
+// sequencing, so a receiver sees the same gaps and late packets a lossy
+// network would produce. Generated data is deterministic for a given frame.
+class LoadGenerator {
+public:
+    static const int MAX_SOURCES = 8;
+
+    struct Config {
+        uint16_t first_universe = 1;
+        int universe_count = 16;
+        double rate_hz = 44.0;
+        uint16_t slots = 512;
+        int sources = 1; // duplicate sources on the same universes
+        int worker_count = 1; // per source
+        size_t queue_capacity = 4096; // per worker
+        SendTarget target;
+        SenderEngine::Impairment impairment;
+        LatencyTuning tuning; // for every source's workers
+    };
+
+    struct Report {
+        double elapsed = 0.0; // seconds since start
+        uint64_t ticks = 0;
+        uint64_t late_ticks = 0; // ticks that started behind schedule
+        uint64_t submitted = 0;
+        uint64_t queue_drops = 0;
+        uint64_t sent = 0;
+        uint64_t impaired_lost = 0;
+        uint64_t impaired_reordered = 0;
+    };
+
+    LoadGenerator();
+    ~LoadGenerator();
+
+    LoadGenerator(const LoadGenerator &) = delete;
+    LoadGenerator &operator=(const LoadGenerator &) = delete;
+
+    bool start(const Config &p_config);
+    void stop();
+    bool is_running() const;
+
+    Report get_report() const;
+    // TuningOption bits refused to any source's workers.
+    uint32_t get_denied_tuning() const;
+
+private:
+    Config config;
+    std::vector<std::unique_ptr<SenderEngine>> engines;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    uint64_t start_ns = 0;
+    uint64_t stop_ns = 0;
+
+    std::atomic<uint64_t> ticks{ 0 };
+    std::atomic<uint64_t> late_ticks{ 0 };
+    std::atomic<uint64_t> submitted{ 0 };
+
+    void _thread_func();
+};
+
+// Checks generated traffic on the receive side. Attach it to a receiver's
+// packet tap: it sees every valid packet with the receiver's sequencing
+// verdict and compares that verdict with the truth from the markers.
+class LoadAnalyzer {
+public:
+    // Log-linear histogram: 8 buckets per power of two of nanoseconds.
+    static const int LATENCY_BUCKETS = 496;
+
+    struct Report {
+        double elapsed = 0.0; // seconds since the first packet
+        uint64_t packets = 0; // valid packets carrying a marker
+        uint64_t foreign = 0; // valid packets without one
+        uint64_t corrupt = 0; // marker present but the pattern is damaged
+        uint64_t bytes = 0;
+        uint64_t lost = 0; // frame numbers never seen (late arrivals refill gaps)
+        uint64_t late = 0; // arrived after a newer frame of the same stream
+        uint64_t duplicates = 0;
+        // Receiver's out-of-order verdicts against the markers.
+        uint64_t detected = 0; // late or duplicate, and discarded
+        uint64_t missed = 0; // late or duplicate, but accepted
+        uint64_t false_alarms = 0; // in order, but discarded
+        double packet_rate = 0.0;
+        double loss_ratio = 0.0;
+        double detection_accuracy = 1.0; // correct verdicts / packets
+        // Latency in ns; percentiles are bucket upper bounds.
+        uint64_t latency_min = 0;
+        uint64_t latency_p50 = 0;
+        uint64_t latency_p90 = 0;
+        uint64_t latency_p99 = 0;
+        uint64_t latency_p999 = 0;
+        uint64_t latency_max = 0;
+        std::vector<uint64_t> latency_histogram; // LATENCY_BUCKETS counts
+    };
+
+    LoadAnalyzer();
+
+    void configure(uint16_t first_universe, int universe_count, int sources);
+    void reset();
+
+    // Hooks record() into the receiver's packet tap; call before it starts.
+    void attach(ReceiverEngine &receiver);
+    // Safe to call from the receive thread while get_report() runs elsewhere.
+    void record(const e131_packet_t &packet, size_t length, bool discarded, uint64_t now_ns);
+
+    Report get_report() const;
+
+    static int latency_bucket(uint64_t ns);
+    static uint64_t latency_bucket_limit(int bucket);
+
+private:
+    struct Stream {
+        int64_t last_frame = -1;
+    };
+
+    mutable std::mutex mtx;
+    uint16_t first_universe = 1;
+    int universe_count = 0;
+    int sources = 1;
+    std::vector<Stream> streams; // source * universe_count + universe offset
+    std::vector<uint64_t> histogram;
+    uint64_t first_ns = 0;
+    uint64_t last_ns = 0;
+    Report totals;
+};
+
+}
+
+#endif
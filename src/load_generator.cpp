@@ -0,0 +1,302 @@
+#include "load_generator.hpp"
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/packed_int64_array.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace godot {
+
+void SacnLoadGenerator::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_first_universe", "universe_id"), &SacnLoadGenerator::set_first_universe);
+    ClassDB::bind_method(D_METHOD("get_first_universe"), &SacnLoadGenerator::get_first_universe);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::INT, "first_universe", PROPERTY_HINT_RANGE, "1,63999,1"), "set_first_universe", "get_first_universe");
+
+    ClassDB::bind_method(D_METHOD("set_universe_count", "count"), &SacnLoadGenerator::set_universe_count);
+    ClassDB::bind_method(D_METHOD("get_universe_count"), &SacnLoadGenerator::get_universe_count);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::INT, "universe_count", PROPERTY_HINT_RANGE, "1,63999,1"), "set_universe_count", "get_universe_count");
+
+    ClassDB::bind_method(D_METHOD("set_rate", "hz"), &SacnLoadGenerator::set_rate);
+    ClassDB::bind_method(D_METHOD("get_rate"), &SacnLoadGenerator::get_rate);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::FLOAT, "rate", PROPERTY_HINT_RANGE, "0.1,10000,0.1,suffix:Hz"), "set_rate", "get_rate");
+
+    ClassDB::bind_method(D_METHOD("set_slots", "slots"), &SacnLoadGenerator::set_slots);
+    ClassDB::bind_method(D_METHOD("get_slots"), &SacnLoadGenerator::get_slots);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::INT, "slots", PROPERTY_HINT_RANGE, "16,512,1"), "set_slots", "get_slots");
+
+    ClassDB::bind_method(D_METHOD("set_sources", "count"), &SacnLoadGenerator::set_sources);
+    ClassDB::bind_method(D_METHOD("get_sources"), &SacnLoadGenerator::get_sources);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::INT, "sources", PROPERTY_HINT_RANGE, "1,8,1"), "set_sources", "get_sources");
+
+    ClassDB::bind_method(D_METHOD("set_worker_count", "count"), &SacnLoadGenerator::set_worker_count);
+    ClassDB::bind_method(D_METHOD("get_worker_count"), &SacnLoadGenerator::get_worker_count);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::INT, "worker_count", PROPERTY_HINT_RANGE, "1,16,1"), "set_worker_count", "get_worker_count");
+
+    ClassDB::bind_method(D_METHOD("set_loss", "probability"), &SacnLoadGenerator::set_loss);
+    ClassDB::bind_method(D_METHOD("get_loss"), &SacnLoadGenerator::get_loss);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::FLOAT, "loss", PROPERTY_HINT_RANGE, "0,1,0.0001"), "set_loss", "get_loss");
+
+    ClassDB::bind_method(D_METHOD("set_reorder", "probability"), &SacnLoadGenerator::set_reorder);
+    ClassDB::bind_method(D_METHOD("get_reorder"), &SacnLoadGenerator::get_reorder);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::FLOAT, "reorder", PROPERTY_HINT_RANGE, "0,1,0.0001"), "set_reorder", "get_reorder");
+
+    ClassDB::bind_method(D_METHOD("set_seed", "seed"), &SacnLoadGenerator::set_seed);
+    ClassDB::bind_method(D_METHOD("get_seed"), &SacnLoadGenerator::get_seed);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
+
+    ClassDB::bind_method(D_METHOD("set_destination_address", "address"), &SacnLoadGenerator::set_destination_address);
+    ClassDB::bind_method(D_METHOD("get_destination_address"), &SacnLoadGenerator::get_destination_address);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::STRING, "destination_address"), "set_destination_address", "get_destination_address");
+
+    ClassDB::bind_method(D_METHOD("set_port", "port_number"), &SacnLoadGenerator::set_port);
+    ClassDB::bind_method(D_METHOD("get_port"), &SacnLoadGenerator::get_port);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::INT, "port"), "set_port", "get_port");
+
+    ClassDB::bind_method(D_METHOD("set_use_multicast", "use_multicast"), &SacnLoadGenerator::set_use_multicast);
+    ClassDB::bind_method(D_METHOD("get_use_multicast"), &SacnLoadGenerator::get_use_multicast);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::BOOL, "use_multicast"), "set_use_multicast", "get_use_multicast");
+
+    ClassDB::bind_method(D_METHOD("set_analyze", "enable"), &SacnLoadGenerator::set_analyze);
+    ClassDB::bind_method(D_METHOD("get_analyze"), &SacnLoadGenerator::get_analyze);
+    ClassDB::add_property("SacnLoadGenerator", PropertyInfo(Variant::BOOL, "analyze"), "set_analyze", "get_analyze");
+
+    ClassDB::bind_method(D_METHOD("start"), &SacnLoadGenerator::start);
+    ClassDB::bind_method(D_METHOD("stop"), &SacnLoadGenerator::stop);
+    ClassDB::bind_method(D_METHOD("is_running"), &SacnLoadGenerator::is_running);
+    ClassDB::bind_method(D_METHOD("get_report"), &SacnLoadGenerator::get_report);
+    ClassDB::bind_method(D_METHOD("reset_report"), &SacnLoadGenerator::reset_report);
+}
+
+SacnLoadGenerator::SacnLoadGenerator() {
+}
+
+SacnLoadGenerator::~SacnLoadGenerator() {
+    stop();
+}
+
+void SacnLoadGenerator::set_first_universe(int p_universe) {
+    first_universe = std::max(1, std::min(p_universe, 63999));
+}
+
+int SacnLoadGenerator::get_first_universe() const {
+    return first_universe;
+}
+
+void SacnLoadGenerator::set_universe_count(int p_count) {
+    universe_count = std::max(1, std::min(p_count, 63999));
+}
+
+int SacnLoadGenerator::get_universe_count() const {
+    return universe_count;
+}
+
+void SacnLoadGenerator::set_rate(double p_rate) {
+    rate = std::max(0.1, std::min(p_rate, 10000.0));
+}
+
+double SacnLoadGenerator::get_rate() const {
+    return rate;
+}
+
+void SacnLoadGenerator::set_slots(int p_slots) {
+    slots = std::max((int)gacn::load_pattern::MARKER_SIZE, std::min(p_slots, 512));
+}
+
+int SacnLoadGenerator::get_slots() const {
+    return slots;
+}
+
+void SacnLoadGenerator::set_sources(int p_sources) {
+    sources = std::max(1, std::min(p_sources, gacn::LoadGenerator::MAX_SOURCES));
+}
+
+int SacnLoadGenerator::get_sources() const {
+    return sources;
+}
+
+void SacnLoadGenerator::set_worker_count(int p_count) {
+    worker_count = std::max(1, std::min(p_count, gacn::SenderEngine::MAX_WORKERS));
+}
+
+int SacnLoadGenerator::get_worker_count() const {
+    return worker_count;
+}
+
+void SacnLoadGenerator::set_loss(double p_loss) {
+    loss = std::max(0.0, std::min(p_loss, 1.0));
+}
+
+double SacnLoadGenerator::get_loss() const {
+    return loss;
+}
+
+void SacnLoadGenerator::set_reorder(double p_reorder) {
+    reorder = std::max(0.0, std::min(p_reorder, 1.0));
+}
+
+double SacnLoadGenerator::get_reorder() const {
+    return reorder;
+}
+
+void SacnLoadGenerator::set_seed(int p_seed) {
+    seed = p_seed;
+}
+
+int SacnLoadGenerator::get_seed() const {
+    return seed;
+}
+
+void SacnLoadGenerator::set_destination_address(const String &p_address) {
+    destination_address = p_address;
+}
+
+String SacnLoadGenerator::get_destination_address() const {
+    return destination_address;
+}
+
+void SacnLoadGenerator::set_port(int p_port) {
+    port = p_port;
+}
+
+int SacnLoadGenerator::get_port() const {
+    return port;
+}
+
+void SacnLoadGenerator::set_use_multicast(bool p_enable) {
+    use_multicast = p_enable;
+}
+
+bool SacnLoadGenerator::get_use_multicast() const {
+    return use_multicast;
+}
+
+void SacnLoadGenerator::set_analyze(bool p_enable) {
+    analyze = p_enable;
+}
+
+bool SacnLoadGenerator::get_analyze() const {
+    return analyze;
+}
+
+bool SacnLoadGenerator::start() {
+    if (generator.is_running()) {
+        return true;
+    }
+    const int count = std::min(universe_count, 63999 - first_universe + 1);
+
+    gacn::LoadGenerator::Config config;
+    config.first_universe = (uint16_t)first_universe;
+    config.universe_count = count;
+    config.rate_hz = rate;
+    config.slots = (uint16_t)slots;
+    config.sources = sources;
+    config.worker_count = worker_count;
+    config.target.multicast = use_multicast;
+    config.target.port = (uint16_t)port;
+    config.impairment.loss = loss;
+    config.impairment.reorder = reorder;
+    config.impairment.seed = (uint64_t)seed;
+    if (!use_multicast) {
+        e131_addr_t resolved;
+        if (e131_unicast_dest(&resolved, destination_address.utf8().get_data(), (uint16_t)port) < 0) {
+            UtilityFunctions::printerr("SacnLoadGenerator: cannot resolve destination ", destination_address);
+            return false;
+        }
+        config.target.unicast_addr = resolved.sin_addr.s_addr;
+    }
+
+    analyzer.configure(config.first_universe, count, sources);
+    if (analyze) {
+        receiver.reset(new gacn::ReceiverEngine((uint16_t)port));
+        analyzer.attach(*receiver);
+        if (!receiver->start()) {
+            UtilityFunctions::printerr("SacnLoadGenerator: cannot receive on port ", port);
+            receiver.reset();
+            return false;
+        }
+        for (int i = 0; i < count; ++i) {
+            receiver->get_memberships().join((uint16_t)(first_universe + i));
+        }
+    }
+
+    if (!generator.start(config)) {
+        UtilityFunctions::printerr("SacnLoadGenerator: failed to start the generator");
+        receiver.reset();
+        return false;
+    }
+    return true;
+}
+
+void SacnLoadGenerator::stop() {
+    generator.stop();
+    // The engine destructor stops the receive thread.
+    receiver.reset();
+}
+
+bool SacnLoadGenerator::is_running() const {
+    return generator.is_running();
+}
+
+Dictionary SacnLoadGenerator::get_report() const {
+    gacn::LoadGenerator::Report tx = generator.get_report();
+    Dictionary result;
+    result["elapsed"] = tx.elapsed;
+    result["ticks"] = (int64_t)tx.ticks;
+    result["late_ticks"] = (int64_t)tx.late_ticks;
+    result["submitted"] = (int64_t)tx.submitted;
+    result["queue_drops"] = (int64_t)tx.queue_drops;
+    result["sent"] = (int64_t)tx.sent;
+    result["impaired_lost"] = (int64_t)tx.impaired_lost;
+    result["impaired_reordered"] = (int64_t)tx.impaired_reordered;
+    if (!analyze) {
+        return result;
+    }
+
+    gacn::LoadAnalyzer::Report rx = analyzer.get_report();
+    result["received"] = (int64_t)rx.packets;
+    result["received_rate"] = rx.packet_rate;
+    result["foreign"] = (int64_t)rx.foreign;
+    result["corrupt"] = (int64_t)rx.corrupt;
+    result["lost"] = (int64_t)rx.lost;
+    result["loss_ratio"] = rx.loss_ratio;
+    result["late"] = (int64_t)rx.late;
+    result["duplicates"] = (int64_t)rx.duplicates;
+    result["detected"] = (int64_t)rx.detected;
+    result["missed"] = (int64_t)rx.missed;
+    result["false_alarms"] = (int64_t)rx.false_alarms;
+    result["detection_accuracy"] = rx.detection_accuracy;
+    result["latency_min_us"] = rx.latency_min / 1000.0;
+    result["latency_p50_us"] = rx.latency_p50 / 1000.0;
+    result["latency_p90_us"] = rx.latency_p90 / 1000.0;
+    result["latency_p99_us"] = rx.latency_p99 / 1000.0;
+    result["latency_p999_us"] = rx.latency_p999 / 1000.0;
+    result["latency_max_us"] = rx.latency_max / 1000.0;
+
+    // One count per power of two of microseconds: entry i covers [2^(i-1), 2^i).
+    std::vector<int64_t> counts;
+    for (int bucket = 0; bucket < gacn::LoadAnalyzer::LATENCY_BUCKETS; ++bucket) {
+        if (rx.latency_histogram[bucket] == 0) {
+            continue;
+        }
+        const uint64_t us = gacn::LoadAnalyzer::latency_bucket_limit(bucket) / 1000;
+        const size_t index = us == 0 ? 0 : 64 - __builtin_clzll(us);
+        if (counts.size() <= index) {
+            counts.resize(index + 1, 0);
+        }
+        counts[index] += (int64_t)rx.latency_histogram[bucket];
+    }
+    PackedInt64Array histogram;
+    histogram.resize(counts.size());
+    for (size_t i = 0; i < counts.size(); ++i) {
+        histogram.set(i, counts[i]);
+    }
+    result["latency_histogram"] = histogram;
+    return result;
+}
+
+void SacnLoadGenerator::reset_report() {
+    analyzer.reset();
+}
+
+}
@@ -0,0 +1,85 @@
+#ifndef LOAD_GENERATOR_HPP
+#define LOAD_GENERATOR_HPP
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+#include "load_engine.hpp"
+
+#include <memory>
+
+namespace godot {
+
+// Soak and capacity test: sends generated universes with optional loss,
+// reordering and duplicate sources, and with `analyze` on, receives them
+// again on `port` to report throughput, loss, out-of-order detection and
+// latency. Settings apply on the next start().
+class SacnLoadGenerator : public Node {
+    GDCLASS(SacnLoadGenerator, Node);
+
+private:
+    int first_universe = 1;
+    int universe_count = 16;
+    double rate = 44.0;
+    int slots = 512;
+    int sources = 1;
+    int worker_count = 1;
+    double loss = 0.0;
+    double reorder = 0.0;
+    int seed = 1;
+    String destination_address = "127.0.0.1";
+    int port = 5569;
+    bool use_multicast = false;
+    bool analyze = true;
+
+    gacn::LoadGenerator generator;
+    gacn::LoadAnalyzer analyzer;
+    std::unique_ptr<gacn::ReceiverEngine> receiver;
+
+protected:
+    static void _bind_methods();
+
+public:
+    SacnLoadGenerator();
+    ~SacnLoadGenerator();
+
+    void set_first_universe(int p_universe);
+    int get_first_universe() const;
+    void set_universe_count(int p_count);
+    int get_universe_count() const;
+    void set_rate(double p_rate);
+    double get_rate() const;
+    void set_slots(int p_slots);
+    int get_slots() const;
+    void set_sources(int p_sources);
+    int get_sources() const;
+    void set_worker_count(int p_count);
+    int get_worker_count() const;
+    void set_loss(double p_loss);
+    double get_loss() const;
+    void set_reorder(double p_reorder);
+    double get_reorder() const;
+    void set_seed(int p_seed);
+    int get_seed() const;
+    void set_destination_address(const String &p_address);
+    String get_destination_address() const;
+    void set_port(int p_port);
+    int get_port() const;
+    void set_use_multicast(bool p_enable);
+    bool get_use_multicast() const;
+    void set_analyze(bool p_enable);
+    bool get_analyze() const;
+
+    bool start();
+    void stop();
+    bool is_running() const;
+
+    // Generator and analyzer counters; latencies in microseconds.
+    Dictionary get_report() const;
+    void reset_report();
+};
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+#include "local_transport.hpp"
+
+#include "sacn_log.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+namespace gacn {
+
+// Slots start on their own cache line after the header.
+static const size_t SLOTS_OFFSET = 64;
+// How long a writer waits for another writer of the same universe before it
+// assumes that writer died mid-update and takes the slot over.
+static const int WRITER_SPIN_LIMIT = 1 << 16;
+
+static long futex(std::atomic<uint32_t> *word, int op, uint32_t value, const struct timespec *timeout) {
+    // Not FUTEX_PRIVATE_FLAG: the word is shared between processes.
+    return syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), op, value, timeout, nullptr, 0);
+}
+
+LocalTransport::LocalTransport() {
+}
+
+bool LocalTransport::_claim(std::atomic<uint32_t> &field, uint32_t value) {
+    uint32_t expected = 0;
+    return field.compare_exchange_strong(expected, value) || expected == value;
+}
+
+LocalTransport::~LocalTransport() {
+    close();
+}
+
+bool LocalTransport::open(uint16_t port) {
+    if (mapping != nullptr) {
+        return true;
+    }
+#if defined(__linux__) && !defined(__ANDROID__)
+    char name[32];
+    std::snprintf(name, sizeof(name), "/gacn-%u", port);
+
+    // Whoever comes first creates the object; ftruncate to the same size is
+    // harmless for everyone else. Pages stay unbacked until a universe is used.
+    const size_t size = SLOTS_OFFSET + sizeof(Slot) * (MAX_UNIVERSE + 1);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        log_error("LocalTransport: shm_open %s failed: %s", name, strerror(errno));
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || ((size_t)info.st_size < size && ftruncate(fd, size) < 0)) {
+        log_error("LocalTransport: cannot size %s: %s", name, strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    void *address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        log_error("LocalTransport: mmap %s failed: %s", name, strerror(errno));
+        return false;
+    }
+
+    // A fresh object is all zeros. Every field is claimed independently, so
+    // concurrent openers agree without any ordering between them.
+    Header *mapped = static_cast<Header *>(address);
+    if (!_claim(mapped->magic, MAGIC) || !_claim(mapped->layout_version, LAYOUT_VERSION) || !_claim(mapped->slot_size, sizeof(Slot))) {
+        log_error("LocalTransport: %s has an incompatible layout, remove /dev/shm%s", name, name);
+        munmap(address, size);
+        return false;
+    }
+
+    mapping = address;
+    mapping_size = size;
+    header = mapped;
+    slots = reinterpret_cast<Slot *>(static_cast<uint8_t *>(address) + SLOTS_OFFSET);
+    return true;
+#else
+    (void)port;
+    log_error("LocalTransport: shared memory transport is not supported on this platform");
+    return false;
+#endif
+}
+
+void LocalTransport::close() {
+    // The object itself stays: other processes may still be using it.
+    if (mapping != nullptr) {
+        munmap(mapping, mapping_size);
+        mapping = nullptr;
+        mapping_size = 0;
+        header = nullptr;
+        slots = nullptr;
+    }
+}
+
+bool LocalTransport::is_open() const {
+    return mapping != nullptr;
+}
+
+void LocalTransport::write(uint16_t universe, const uint8_t *cid, uint8_t priority, uint8_t options, uint8_t sequence, const uint8_t *data, uint16_t length) {
+    if (slots == nullptr || universe > MAX_UNIVERSE || length > 512) {
+        return;
+    }
+    Slot &slot = slots[universe];
+
+    // Taking the slot makes its sequence odd, which also tells readers a
+    // write is in progress.
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    for (int spin = 0;; ++spin) {
+        if ((seq & 1) == 0 && slot.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            break;
+        }
+        if (spin == WRITER_SPIN_LIMIT) {
+            break;
+        }
+        seq = slot.seq.load(std::memory_order_relaxed);
+    }
+    seq |= 1;
+    slot.seq.store(seq, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.length = length;
+    slot.priority = priority;
+    slot.options = options;
+    slot.sequence = sequence;
+    std::memcpy(slot.cid, cid, sizeof(slot.cid));
+    std::memcpy(slot.data, data, length);
+
+    slot.seq.store(seq + 1, std::memory_order_release);
+}
+
+void LocalTransport::ring() {
+    if (header == nullptr) {
+        return;
+    }
+    header->doorbell.fetch_add(1, std::memory_order_seq_cst);
+    if (header->waiters.load(std::memory_order_seq_cst) != 0) {
+        futex(&header->doorbell, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+}
+
+bool LocalTransport::read(uint16_t universe, uint32_t &seen, Frame &out) const {
+    if (slots == nullptr || universe > MAX_UNIVERSE) {
+        return false;
+    }
+    const Slot &slot = slots[universe];
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        const uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before == seen) {
+            return false;
+        }
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint16_t length = slot.length;
+        length = length > 512 ? 512 : length;
+        out.length = length;
+        out.priority = slot.priority;
+        out.options = slot.options;
+        out.sequence = slot.sequence;
+        std::memcpy(out.cid, slot.cid, sizeof(out.cid));
+        std::memcpy(out.data, slot.data, length);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == before) {
+            seen = before;
+            return true;
+        }
+    }
+    // Still being rewritten; the next doorbell brings us back.
+    return false;
+}
+
+uint32_t LocalTransport::get_version(uint16_t universe) const {
+    if (slots == nullptr || universe > MAX_UNIVERSE) {
+        return 0;
+    }
+    return slots[universe].seq.load(std::memory_order_acquire);
+}
+
+uint32_t LocalTransport::get_doorbell() const {
+    return header != nullptr ? header->doorbell.load(std::memory_order_seq_cst) : 0;
+}
+
+void LocalTransport::wait(uint32_t doorbell, int timeout_ms) {
+    if (header == nullptr) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return;
+    }
+    // Pairs with ring(): either the writer sees us waiting, or we see the new
+    // doorbell value and the kernel refuses to sleep.
+    header->waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (header->doorbell.load(std::memory_order_seq_cst) == doorbell) {
+        struct timespec timeout;
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_nsec = (long)(timeout_ms % 1000) * 1000000;
+        futex(&header->doorbell, FUTEX_WAIT, doorbell, &timeout);
+    }
+    header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+}
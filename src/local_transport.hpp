@@ -0,0 +1,93 @@
+#ifndef LOCAL_TRANSPORT_HPP
+#define LOCAL_TRANSPORT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace gacn {
+
+// Shared-memory universe table for senders and receivers on the same machine,
+// in one process or several (editor and running game). The table for a port
+// lives in the POSIX shared memory object "/gacn-<port>" and holds one slot
+// per universe guarded by a seqlock: writers never block readers, and readers
+// copy a slot only when its sequence changed. A futex in the header acts as a
+// doorbell so idle readers sleep until a writer rings.
+//
+// A slot holds the latest frame written to a universe. With several local
+// sources on one universe a reader may miss intermediate frames, but every
+// source keeps its own CID and sequence numbers so merging still works.
+class LocalTransport {
+public:
+    static const uint32_t MAGIC = 0x6e636167; // "gacn"
+    static const uint32_t LAYOUT_VERSION = 1;
+    static const uint16_t MAX_UNIVERSE = 63999;
+
+    // One universe as published by a sender, after output processing.
+    struct Frame {
+        uint8_t cid[16];
+        uint8_t priority;
+        uint8_t options; // E1.31 framing options (preview, terminated)
+        uint8_t sequence;
+        uint16_t length;
+        uint8_t data[512];
+    };
+
+    LocalTransport();
+    ~LocalTransport();
+
+    LocalTransport(const LocalTransport &) = delete;
+    LocalTransport &operator=(const LocalTransport &) = delete;
+
+    // Maps (creating if needed) the table for a port.
+    bool open(uint16_t port);
+    void close();
+    bool is_open() const;
+
+    // Writer side. write() is lock-free unless two writers hit the same
+    // universe at once; ring() wakes sleeping readers and only enters the
+    // kernel when one is waiting.
+    void write(uint16_t universe, const uint8_t *cid, uint8_t priority, uint8_t options, uint8_t sequence, const uint8_t *data, uint16_t length);
+    void ring();
+
+    // Reader side. read() copies the slot if it changed since `seen` and
+    // updates `seen`; it returns false if there is nothing new. Start with 0
+    // to take the frame already there, or with get_version() to skip it.
+    bool read(uint16_t universe, uint32_t &seen, Frame &out) const;
+    uint32_t get_version(uint16_t universe) const;
+    uint32_t get_doorbell() const;
+    // Sleeps until the doorbell moves past `doorbell` or the timeout expires.
+    void wait(uint32_t doorbell, int timeout_ms);
+
+private:
+    struct Header {
+        std::atomic<uint32_t> magic;
+        std::atomic<uint32_t> layout_version;
+        std::atomic<uint32_t> slot_size;
+        std::atomic<uint32_t> doorbell; // futex word
+        std::atomic<uint32_t> waiters;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> seq; // odd while a write is in progress
+        uint16_t length;
+        uint8_t priority;
+        uint8_t options;
+        uint8_t sequence;
+        uint8_t cid[16];
+        uint8_t data[512];
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+    void *mapping = nullptr;
+    size_t mapping_size = 0;
+    Header *header = nullptr;
+    Slot *slots = nullptr;
+
+    static bool _claim(std::atomic<uint32_t> &field, uint32_t value);
+};
+
+}
+
+#endif
@@ -0,0 +1,391 @@
+#include "membership_manager.hpp"
+
+#include "e131.h"
+#include "sacn_log.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace gacn {
+
+MembershipManager::MembershipManager(uint16_t port) :
+        port(port), per_socket_limit(_read_igmp_limit()) {
+    interfaces.emplace_back();
+    for (auto &flag : joined) {
+        flag.store(0, std::memory_order_relaxed);
+    }
+}
+
+MembershipManager::~MembershipManager() {
+    close_all();
+}
+
+int MembershipManager::_read_igmp_limit() {
+    int limit = 20; // kernel default
+    FILE *file = std::fopen("/proc/sys/net/ipv4/igmp_max_memberships", "r");
+    if (file != nullptr) {
+        if (std::fscanf(file, "%d", &limit) != 1 || limit < 1) {
+            limit = 20;
+        }
+        std::fclose(file);
+    }
+    return limit;
+}
+
+void MembershipManager::set_max_sockets(int count) {
+    std::lock_guard<std::mutex> lock(mtx);
+    max_sockets = count < 1 ? 1 : count;
+}
+
+int MembershipManager::get_max_sockets() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return max_sockets;
+}
+
+void MembershipManager::set_socket_tuning(const LatencyTuning &p_tuning) {
+    std::lock_guard<std::mutex> lock(mtx);
+    tuning = p_tuning;
+}
+
+uint32_t MembershipManager::get_denied_tuning() const {
+    return denied_tuning.load();
+}
+
+void MembershipManager::set_interfaces(const std::vector<NetInterface> &p_interfaces) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!sockets.empty()) {
+        log_error("MembershipManager: interfaces cannot change while open");
+        return;
+    }
+    interfaces = p_interfaces;
+    if (interfaces.size() > (size_t)MAX_INTERFACES) {
+        log_error("MembershipManager: only the first %d interfaces are used", MAX_INTERFACES);
+        interfaces.resize(MAX_INTERFACES);
+    }
+    if (interfaces.empty()) {
+        interfaces.emplace_back();
+    }
+}
+
+int MembershipManager::get_interface_count() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return (int)interfaces.size();
+}
+
+const NetInterface &MembershipManager::get_interface(int interface) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return interfaces[interface];
+}
+
+int MembershipManager::_open_socket() {
+    int fd = e131_socket();
+    if (fd < 0) {
+        log_error("MembershipManager: e131_socket failed: %s", strerror(errno));
+        return -1;
+    }
+
+    // All pool sockets share the E1.31 port.
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef IP_MULTICAST_ALL
+    int zero = 0;
+    if (setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &zero, sizeof(zero)) < 0) {
+        log_error("MembershipManager: IP_MULTICAST_ALL failed: %s", strerror(errno));
+    }
+#endif
+    // Each datagram's destination address, for recordings.
+    if (setsockopt(fd, IPPROTO_IP, IP_PKTINFO, &one, sizeof(one)) < 0) {
+        log_error("MembershipManager: IP_PKTINFO failed: %s", strerror(errno));
+    }
+
+    if (e131_bind(fd, port) < 0) {
+        log_error("MembershipManager: e131_bind failed: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    denied_tuning.fetch_or(apply_socket_tuning(fd, tuning, true, "MembershipManager"));
+
+    // The receive loop drains sockets until EAGAIN.
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+}
+
+bool MembershipManager::open() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!sockets.empty()) {
+        return true;
+    }
+    denied_tuning = 0;
+    for (size_t i = 0; i < interfaces.size(); ++i) {
+        if (wake_fds.size() <= i) {
+            wake_fds.push_back(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        }
+        int fd = _open_socket();
+        if (fd < 0) {
+            for (const PooledSocket &socket : sockets) {
+                close(socket.fd);
+            }
+            sockets.clear();
+            return false;
+        }
+        sockets.push_back({ fd, (int)i, 0 });
+    }
+    generation.fetch_add(1);
+    return true;
+}
+
+void MembershipManager::close_all() {
+    std::lock_guard<std::mutex> lock(mtx);
+    // No need to explicitly leave multicast groups, closing the sockets handles it.
+    for (const PooledSocket &socket : sockets) {
+        close(socket.fd);
+    }
+    sockets.clear();
+    joined_count = 0;
+    joined_list.clear();
+    join_version.fetch_add(1);
+    for (auto &flag : joined) {
+        flag.store(0, std::memory_order_relaxed);
+    }
+    for (int fd : wake_fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    wake_fds.clear();
+    generation.fetch_add(1);
+}
+
+bool MembershipManager::is_open() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return !sockets.empty();
+}
+
+bool MembershipManager::_joins_by_address(int interface) const {
+    const NetInterface &iface = interfaces[interface];
+    return iface.index == 0 && iface.address != 0;
+}
+
+int MembershipManager::_join_socket(int fd, uint16_t universe, int interface) {
+    const NetInterface &iface = interfaces[interface];
+    if (_joins_by_address(interface)) {
+        char address[INET_ADDRSTRLEN];
+        struct in_addr in;
+        in.s_addr = iface.address;
+        inet_ntop(AF_INET, &in, address, sizeof(address));
+        return e131_multicast_join_ifaddr(fd, universe, address);
+    }
+    return e131_multicast_join_iface(fd, universe, iface.index);
+}
+
+int MembershipManager::_leave_socket(int fd, uint16_t universe, int interface) {
+    const NetInterface &iface = interfaces[interface];
+    struct ip_mreqn mreq;
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_multiaddr.s_addr = htonl(0xefff0000 | universe);
+    if (_joins_by_address(interface)) {
+        mreq.imr_address.s_addr = iface.address;
+    } else {
+        mreq.imr_ifindex = iface.index;
+    }
+    return setsockopt(fd, IPPROTO_IP, IP_DROP_MEMBERSHIP, &mreq, sizeof(mreq));
+}
+
+bool MembershipManager::join(uint16_t universe, int interface) {
+    if (universe < 1 || universe > 63999) {
+        log_error("MembershipManager: invalid universe %u", universe);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (sockets.empty()) {
+        log_error("MembershipManager: not open, cannot join universe %u", universe);
+        return false;
+    }
+    if (interface < 0 || interface >= (int)interfaces.size()) {
+        log_error("MembershipManager: cannot join universe %u on interface %d, %d configured", universe, interface, (int)interfaces.size());
+        return false;
+    }
+    const int current = joined[universe].load(std::memory_order_relaxed);
+    if (current == interface + 1) {
+        return true;
+    }
+    if (current != 0) {
+        log_error("MembershipManager: universe %u is already joined on interface %d", universe, current - 1);
+        return false;
+    }
+
+    // Fill existing sockets first; the kernel may report ENOBUFS before our
+    // own count reaches the limit if something else changed it.
+    int interface_sockets = 0;
+    for (PooledSocket &socket : sockets) {
+        if (socket.interface != interface) {
+            continue;
+        }
+        interface_sockets++;
+        if (socket.memberships >= per_socket_limit) {
+            continue;
+        }
+        if (_join_socket(socket.fd, universe, interface) == 0) {
+            socket.memberships++;
+            _mark_joined(universe, interface);
+            return true;
+        }
+        if (errno != ENOBUFS) {
+            log_error("MembershipManager: %s failed for universe %u: %s",
+                    _joins_by_address(interface) ? "e131_multicast_join_ifaddr" : "e131_multicast_join_iface", universe, strerror(errno));
+            return false;
+        }
+        socket.memberships = per_socket_limit;
+    }
+
+    if (interface_sockets >= max_sockets) {
+        log_error("MembershipManager: cannot join universe %u, all %d sockets are full (%d memberships each, %d joined). Raise max_sockets or net.ipv4.igmp_max_memberships.",
+                universe, max_sockets, per_socket_limit, joined_count);
+        return false;
+    }
+
+    int fd = _open_socket();
+    if (fd < 0) {
+        return false;
+    }
+    if (_join_socket(fd, universe, interface) < 0) {
+        log_error("MembershipManager: %s failed for universe %u: %s",
+                _joins_by_address(interface) ? "e131_multicast_join_ifaddr" : "e131_multicast_join_iface", universe, strerror(errno));
+        close(fd);
+        return false;
+    }
+    sockets.push_back({ fd, interface, 1 });
+    _mark_joined(universe, interface);
+
+    generation.fetch_add(1);
+    uint64_t one = 1;
+    if (write(wake_fds[interface], &one, sizeof(one)) < 0) {
+        // The receive loop still picks the socket up on its next timeout.
+    }
+    return true;
+}
+
+int MembershipManager::join_range(uint16_t first, int count, int interface) {
+    int result = 0;
+    for (int i = 0; i < count; ++i) {
+        int universe = (int)first + i;
+        if (universe > 63999) {
+            break;
+        }
+        if (join((uint16_t)universe, interface)) {
+            result++;
+        }
+    }
+    return result;
+}
+
+bool MembershipManager::leave(uint16_t universe) {
+    std::lock_guard<std::mutex> lock(mtx);
+    const int interface = joined[universe].load(std::memory_order_relaxed) - 1;
+    if (interface < 0) {
+        return false;
+    }
+
+    // Only the socket holding the membership accepts the drop; the others
+    // report EADDRNOTAVAIL.
+    bool dropped = false;
+    for (PooledSocket &socket : sockets) {
+        if (socket.interface == interface && _leave_socket(socket.fd, universe, interface) == 0) {
+            // A socket marked full after ENOBUFS is simply tried again on
+            // the next join.
+            if (socket.memberships > 0) {
+                socket.memberships--;
+            }
+            dropped = true;
+            break;
+        }
+    }
+    if (!dropped) {
+        log_error("MembershipManager: IP_DROP_MEMBERSHIP failed for universe %u: %s", universe, strerror(errno));
+    }
+
+    // Forget it either way, so the universe can be joined again.
+    joined_count--;
+    for (size_t i = 0; i < joined_list.size(); ++i) {
+        if (joined_list[i] == universe) {
+            joined_list.erase(joined_list.begin() + i);
+            break;
+        }
+    }
+    joined[universe].store(0, std::memory_order_release);
+    join_version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void MembershipManager::_mark_joined(uint16_t universe, int interface) {
+    joined_count++;
+    joined_list.push_back(universe);
+    joined[universe].store((uint8_t)(interface + 1), std::memory_order_release);
+    join_version.fetch_add(1, std::memory_order_release);
+}
+
+bool MembershipManager::is_joined(uint16_t universe) const {
+    return joined[universe].load(std::memory_order_acquire) != 0;
+}
+
+int MembershipManager::get_joined_interface(uint16_t universe) const {
+    return (int)joined[universe].load(std::memory_order_acquire) - 1;
+}
+
+void MembershipManager::get_joined_universes(std::vector<uint16_t> &out) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    out = joined_list;
+}
+
+uint32_t MembershipManager::get_join_version() const {
+    return join_version.load(std::memory_order_acquire);
+}
+
+MembershipManager::Capacity MembershipManager::get_capacity() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    Capacity capacity;
+    capacity.interfaces = (int)interfaces.size();
+    capacity.sockets = (int)sockets.size();
+    capacity.max_sockets = max_sockets;
+    capacity.per_socket = per_socket_limit;
+    capacity.joined = joined_count;
+    capacity.capacity = capacity.interfaces * max_sockets * per_socket_limit;
+    return capacity;
+}
+
+uint32_t MembershipManager::get_generation() const {
+    return generation.load(std::memory_order_acquire);
+}
+
+void MembershipManager::get_sockets(int interface, std::vector<int> &out) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    out.clear();
+    for (const PooledSocket &socket : sockets) {
+        if (socket.interface == interface) {
+            out.push_back(socket.fd);
+        }
+    }
+}
+
+int MembershipManager::get_wake_fd(int interface) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return interface < (int)wake_fds.size() ? wake_fds[interface] : -1;
+}
+
+void MembershipManager::clear_wake(int interface) {
+    uint64_t value;
+    if (read(get_wake_fd(interface), &value, sizeof(value)) < 0) {
+        // Nothing pending.
+    }
+}
+
+}
@@ -0,0 +1,121 @@
+#ifndef MEMBERSHIP_MANAGER_HPP
+#define MEMBERSHIP_MANAGER_HPP
+
+#include "net_interface.hpp"
+#include "thread_tuning.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace gacn {
+
+// Spreads E1.31 multicast memberships over a pool of sockets bound to the same
+// port. Linux limits each socket to igmp_max_memberships groups (20 by
+// default), so a new socket is opened whenever the current ones are full.
+// Every socket disables IP_MULTICAST_ALL so it only sees its own groups and
+// a datagram is never delivered twice.
+//
+// Memberships can be spread over several network interfaces. Each interface
+// has its own sockets and wake fd, so a receive thread per interface can
+// service them in parallel; a universe is joined on one interface at a time.
+class MembershipManager {
+public:
+    static const int DEFAULT_MAX_SOCKETS = 64;
+    static const int MAX_INTERFACES = 8;
+
+    struct Capacity {
+        int interfaces = 0;
+        int sockets = 0;
+        int max_sockets = 0; // per interface
+        int per_socket = 0;
+        int joined = 0;
+        int capacity = 0; // interfaces * max_sockets * per_socket
+    };
+
+    explicit MembershipManager(uint16_t port);
+    ~MembershipManager();
+
+    MembershipManager(const MembershipManager &) = delete;
+    MembershipManager &operator=(const MembershipManager &) = delete;
+
+    void set_max_sockets(int count);
+    int get_max_sockets() const;
+    // Busy polling and buffer size for sockets opened from now on.
+    void set_socket_tuning(const LatencyTuning &p_tuning);
+    // TuningOption bits the OS refused since open().
+    uint32_t get_denied_tuning() const;
+    // Interfaces to join on, at most MAX_INTERFACES; an empty list means the
+    // default interface. Ignored while open.
+    void set_interfaces(const std::vector<NetInterface> &p_interfaces);
+    int get_interface_count() const;
+    const NetInterface &get_interface(int interface) const;
+
+    // Opens the first socket of every interface. They are bound to the port
+    // on all addresses, so they also receive unicast traffic.
+    bool open();
+    void close_all();
+    bool is_open() const;
+
+    // Joins the multicast group of a universe on one of the interfaces.
+    // Returns true if the universe is (now) joined there; failures are logged
+    // with the reason.
+    bool join(uint16_t universe, int interface = 0);
+    // Returns how many of the universes in [first, first + count) are joined.
+    int join_range(uint16_t first, int count, int interface = 0);
+    // Drops the universe's group, so it can be joined again on any interface.
+    // Returns false if it was not joined.
+    bool leave(uint16_t universe);
+    // Lock-free, safe from the receive thread.
+    bool is_joined(uint16_t universe) const;
+    // The interface a universe is joined on, -1 if it is not.
+    int get_joined_interface(uint16_t universe) const;
+    // Joined universes in join order; join_version changes with every join
+    // and leave.
+    void get_joined_universes(std::vector<uint16_t> &out) const;
+    uint32_t get_join_version() const;
+
+    Capacity get_capacity() const;
+
+    // Receive loop support, per interface: generation changes whenever a
+    // socket is added, and that interface's wake fd becomes readable.
+    uint32_t get_generation() const;
+    void get_sockets(int interface, std::vector<int> &out) const;
+    int get_wake_fd(int interface) const;
+    void clear_wake(int interface);
+
+private:
+    struct PooledSocket {
+        int fd;
+        int interface;
+        int memberships;
+    };
+
+    uint16_t port;
+    int max_sockets = DEFAULT_MAX_SOCKETS;
+    int per_socket_limit;
+    std::vector<NetInterface> interfaces;
+    std::vector<int> wake_fds; // one per interface while open
+    LatencyTuning tuning;
+    std::atomic<uint32_t> denied_tuning{ 0 };
+
+    mutable std::mutex mtx;
+    std::vector<PooledSocket> sockets;
+    int joined_count = 0;
+    std::vector<uint16_t> joined_list;
+    std::atomic<uint32_t> join_version{ 0 };
+    std::atomic<uint32_t> generation{ 0 };
+    std::atomic<uint8_t> joined[65536]; // interface + 1, 0 if not joined
+
+    int _open_socket();
+    bool _joins_by_address(int interface) const;
+    int _join_socket(int fd, uint16_t universe, int interface);
+    int _leave_socket(int fd, uint16_t universe, int interface);
+    void _mark_joined(uint16_t universe, int interface);
+    static int _read_igmp_limit();
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace gacn {
+
+// Bounded lock-free multi-producer / single-consumer ring buffer.
+//
+// Every cell carries a sequence number that tells producers and the consumer
+// whose turn it is (D. Vyukov's bounded queue). Producers claim a cell with a
+// single CAS on the enqueue position and fill it in place, so large payloads
+// are written exactly once. The consumer side is wait-free and must only ever
+// be driven by one thread.
+template <typename T>
+class MpscQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+
+    alignas(64) std::atomic<size_t> enqueue_pos{ 0 };
+    alignas(64) size_t dequeue_pos = 0;
+
+public:
+    // Capacity is rounded up to the next power of two.
+    explicit MpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+    // Claims a free cell and calls fill(T &) on it. Safe from any thread.
+    // Returns false without calling fill when the queue is full.
+    template <typename F>
+    bool try_push(F &&fill) {
+        Cell *cell;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        fill(cell->value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Calls consume(T &) on the oldest published cell. Consumer thread only.
+    template <typename F>
+    bool try_pop(F &&consume) {
+        Cell *cell = &cells[dequeue_pos & mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(dequeue_pos + 1) < 0) {
+            return false;
+        }
+        consume(cell->value);
+        cell->sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+        ++dequeue_pos;
+        return true;
+    }
+
+    // True when the next cell has not been published yet. Consumer thread only.
+    bool empty() const {
+        const Cell *cell = &cells[dequeue_pos & mask];
+        return (intptr_t)cell->sequence.load(std::memory_order_acquire) - (intptr_t)(dequeue_pos + 1) < 0;
+    }
+};
+
+}
+
+#endif
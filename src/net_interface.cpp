@@ -0,0 +1,91 @@
+#include "net_interface.hpp"
+
+#include "sacn_log.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+
+namespace gacn {
+
+// Fills in whichever of name, index and address is still missing.
+static bool complete_interface(NetInterface &iface) {
+    struct ifaddrs *list = nullptr;
+    if (getifaddrs(&list) < 0) {
+        log_error("resolve_interface: getifaddrs failed: %s", strerror(errno));
+        return false;
+    }
+    bool found = false;
+    for (struct ifaddrs *entry = list; entry != nullptr; entry = entry->ifa_next) {
+        if (entry->ifa_addr == nullptr || entry->ifa_addr->sa_family != AF_INET) {
+            continue;
+        }
+        const uint32_t address = ((const struct sockaddr_in *)entry->ifa_addr)->sin_addr.s_addr;
+        const bool match = iface.address != 0 ? address == iface.address : iface.name == entry->ifa_name;
+        if (match) {
+            iface.name = entry->ifa_name;
+            iface.address = address;
+            found = true;
+            break;
+        }
+    }
+    freeifaddrs(list);
+
+    if (!found && iface.address != 0) {
+        return false;
+    }
+    // An interface without an IPv4 address still has an index to send on.
+    iface.index = (int)if_nametoindex(iface.name.c_str());
+    return iface.index != 0;
+}
+
+bool resolve_interface(const std::string &spec, NetInterface &out) {
+    out = NetInterface();
+    if (spec.empty() || spec == "default") {
+        return true;
+    }
+
+    struct in_addr address;
+    char *end = nullptr;
+    const long index = std::strtol(spec.c_str(), &end, 10);
+    if (inet_pton(AF_INET, spec.c_str(), &address) == 1) {
+        out.address = address.s_addr;
+    } else if (*end == '\0' && index > 0) {
+        char name[IF_NAMESIZE];
+        if (if_indextoname((unsigned int)index, name) == nullptr) {
+            log_error("resolve_interface: no interface with index %ld", index);
+            return false;
+        }
+        out.name = name;
+    } else {
+        out.name = spec;
+    }
+
+    if (!complete_interface(out)) {
+        log_error("resolve_interface: no network interface matches '%s'", spec.c_str());
+        out = NetInterface();
+        return false;
+    }
+    return true;
+}
+
+bool resolve_interfaces(const std::vector<std::string> &specs, std::vector<NetInterface> &out) {
+    out.clear();
+    for (const std::string &spec : specs) {
+        NetInterface iface;
+        if (!resolve_interface(spec, iface)) {
+            return false;
+        }
+        out.push_back(iface);
+    }
+    if (out.empty()) {
+        out.emplace_back();
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,28 @@
+#ifndef NET_INTERFACE_HPP
+#define NET_INTERFACE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gacn {
+
+// A network interface that sACN traffic is bound to. index 0 leaves the
+// choice to the routing table, which is what an empty spec resolves to.
+struct NetInterface {
+    std::string name;
+    int index = 0;
+    uint32_t address = 0; // first IPv4 address, network byte order, 0 if none
+};
+
+// Resolves an interface by name ("eth1"), index ("3") or one of its IPv4
+// addresses ("10.0.0.5"). Returns false with a logged reason if no such
+// interface exists.
+bool resolve_interface(const std::string &spec, NetInterface &out);
+
+// Resolves every spec; an empty list gives the default interface alone.
+bool resolve_interfaces(const std::vector<std::string> &specs, std::vector<NetInterface> &out);
+
+}
+
+#endif
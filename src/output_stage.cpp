@@ -0,0 +1,228 @@
+#include "output_stage.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace gacn {
+
+static inline float clamp01(float v) {
+    return std::min(std::max(v, 0.0f), 1.0f);
+}
+
+// Evaluates the configured transfer curve at t in [0, 1].
+static float eval_curve(const std::vector<float> &curve, float gamma, float t) {
+    if (curve.size() < 2) {
+        return gamma == 1.0f ? t : std::pow(t, gamma);
+    }
+    const float x = t * (float)(curve.size() - 1);
+    const size_t i = std::min((size_t)x, curve.size() - 2);
+    const float f = x - (float)i;
+    return clamp01(curve[i] + (curve[i + 1] - curve[i]) * f);
+}
+
+OutputStage::OutputStage() {
+    for (int i = 0; i < MAX_GROUPS; ++i) {
+        group_dimmers[i].store(1.0f, std::memory_order_relaxed);
+    }
+    published = std::make_shared<const ProfileTable>();
+    identity_profile = *_build_profile(UniverseConfig());
+}
+
+OutputStage::~OutputStage() {
+    std::free(dither_residuals.load());
+}
+
+void OutputStage::set_master_dimmer(float value) {
+    master_dimmer.store(clamp01(value), std::memory_order_relaxed);
+}
+
+float OutputStage::get_master_dimmer() const {
+    return master_dimmer.load(std::memory_order_relaxed);
+}
+
+void OutputStage::set_group_dimmer(int group, float value) {
+    if (group < 0 || group >= MAX_GROUPS) {
+        return;
+    }
+    group_dimmers[group].store(clamp01(value), std::memory_order_relaxed);
+}
+
+float OutputStage::get_group_dimmer(int group) const {
+    if (group < 0 || group >= MAX_GROUPS) {
+        return 1.0f;
+    }
+    return group_dimmers[group].load(std::memory_order_relaxed);
+}
+
+void OutputStage::set_dithering(bool enabled) {
+    if (enabled && dither_residuals.load(std::memory_order_acquire) == nullptr) {
+        std::lock_guard<std::mutex> lock(config_mtx);
+        if (dither_residuals.load(std::memory_order_relaxed) == nullptr) {
+            dither_residuals.store((uint8_t *)std::calloc(MAX_UNIVERSES, 512), std::memory_order_release);
+        }
+    }
+    dithering.store(enabled, std::memory_order_relaxed);
+}
+
+bool OutputStage::get_dithering() const {
+    return dithering.load(std::memory_order_relaxed);
+}
+
+void OutputStage::set_universe_group(uint16_t universe, int group) {
+    std::lock_guard<std::mutex> lock(config_mtx);
+    configs[universe].group = std::min(std::max(group, 0), MAX_GROUPS - 1);
+    _publish(universe);
+}
+
+void OutputStage::set_universe_gamma(uint16_t universe, float gamma) {
+    std::lock_guard<std::mutex> lock(config_mtx);
+    UniverseConfig &config = configs[universe];
+    config.gamma = std::max(gamma, 0.01f);
+    config.curve.clear();
+    _publish(universe);
+}
+
+void OutputStage::set_universe_curve(uint16_t universe, const float *points, size_t count) {
+    std::lock_guard<std::mutex> lock(config_mtx);
+    UniverseConfig &config = configs[universe];
+    config.curve.assign(points, points + count);
+    _publish(universe);
+}
+
+void OutputStage::set_universe_wide_channels(uint16_t universe, const uint16_t *slots, size_t count) {
+    std::lock_guard<std::mutex> lock(config_mtx);
+    UniverseConfig &config = configs[universe];
+    config.wide_slots.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (slots[i] < 511) {
+            config.wide_slots.push_back(slots[i]);
+        }
+    }
+    _publish(universe);
+}
+
+void OutputStage::set_channel_gains(uint16_t universe, uint16_t first_slot, const float *gains, size_t count) {
+    std::lock_guard<std::mutex> lock(config_mtx);
+    UniverseConfig &config = configs[universe];
+    if (config.gains.empty()) {
+        config.gains.assign(512, 1.0f);
+    }
+    for (size_t i = 0; i < count && first_slot + i < 512; ++i) {
+        config.gains[first_slot + i] = clamp01(gains[i]);
+    }
+    _publish(universe);
+}
+
+void OutputStage::clear_universe(uint16_t universe) {
+    std::lock_guard<std::mutex> lock(config_mtx);
+    configs.erase(universe);
+    _publish(universe);
+}
+
+std::shared_ptr<const OutputStage::Profile> OutputStage::_build_profile(const UniverseConfig &config) const {
+    std::shared_ptr<Profile> profile = std::make_shared<Profile>();
+    profile->group = config.group;
+
+    for (int x = 0; x < 256; ++x) {
+        float y = eval_curve(config.curve, config.gamma, (float)x / 255.0f);
+        profile->lut8[x] = (uint16_t)std::lround(y * 255.0f * 256.0f);
+    }
+
+    profile->wide_slots = config.wide_slots;
+    if (!profile->wide_slots.empty()) {
+        profile->lut16.resize(65536);
+        for (int x = 0; x < 65536; ++x) {
+            float y = eval_curve(config.curve, config.gamma, (float)x / 65535.0f);
+            profile->lut16[x] = (uint16_t)std::lround(y * 65535.0f);
+        }
+    }
+
+    bool unity_gain = true;
+    for (int i = 0; i < 512; ++i) {
+        float g = config.gains.empty() ? 1.0f : config.gains[i];
+        profile->gain[i] = (uint16_t)std::lround(g * 32768.0f);
+        unity_gain = unity_gain && profile->gain[i] == 32768;
+    }
+
+    bool linear = config.curve.empty() && config.gamma == 1.0f;
+    profile->identity = linear && unity_gain && profile->wide_slots.empty();
+    return profile;
+}
+
+void OutputStage::_publish(uint16_t universe) {
+    std::shared_ptr<ProfileTable> table = std::make_shared<ProfileTable>(*published);
+    auto it = configs.find(universe);
+    if (it == configs.end()) {
+        table->erase(universe);
+    } else {
+        (*table)[universe] = _build_profile(it->second);
+    }
+    std::atomic_store(&published, std::shared_ptr<const ProfileTable>(table));
+    version.fetch_add(1, std::memory_order_release);
+}
+
+void OutputStage::process(ThreadState &state, uint16_t universe, const uint8_t *in, uint8_t *out, uint16_t length) {
+    const uint32_t v = version.load(std::memory_order_acquire);
+    if (v != state.seen_version) {
+        state.seen_version = v;
+        state.current = std::atomic_load(&published);
+    }
+
+    const Profile *profile = nullptr;
+    if (state.current) {
+        auto it = state.current->find(universe);
+        if (it != state.current->end()) {
+            profile = it->second.get();
+        }
+    }
+
+    // Universes without a profile belong to group 0.
+    const int group = profile != nullptr ? profile->group : 0;
+    const float dimmer = master_dimmer.load(std::memory_order_relaxed) * group_dimmers[group].load(std::memory_order_relaxed);
+    const uint32_t scale = (uint32_t)std::lround(dimmer * 32768.0f);
+
+    if ((profile == nullptr || profile->identity) && scale == 32768) {
+        std::memcpy(out, in, length);
+        return;
+    }
+    if (profile == nullptr) {
+        profile = &identity_profile;
+    }
+
+    // 8-bit gather: LUT, calibration gain, dimmer, then round or dither.
+    const uint16_t *lut = profile->lut8;
+    const uint16_t *gain = profile->gain;
+    uint8_t *residuals = dither_residuals.load(std::memory_order_acquire);
+    if (dithering.load(std::memory_order_relaxed) && residuals != nullptr && universe < MAX_UNIVERSES) {
+        // A universe is only ever processed by one thread at a time.
+        uint8_t *residual = residuals + (size_t)universe * 512;
+        for (uint16_t i = 0; i < length; ++i) {
+            uint32_t value = ((((uint32_t)lut[in[i]] * gain[i]) >> 15) * scale >> 15) + residual[i];
+            out[i] = (uint8_t)(value >> 8);
+            residual[i] = (uint8_t)value;
+        }
+    } else {
+        for (uint16_t i = 0; i < length; ++i) {
+            uint32_t value = (((uint32_t)lut[in[i]] * gain[i]) >> 15) * scale >> 15;
+            out[i] = (uint8_t)((value + 128) >> 8);
+        }
+    }
+
+    // 16-bit pairs overwrite their two slots from the full-resolution LUT.
+    if (!profile->wide_slots.empty()) {
+        const uint16_t *lut16 = profile->lut16.data();
+        for (uint16_t slot : profile->wide_slots) {
+            if (slot + 1 >= length) {
+                continue;
+            }
+            uint32_t value = lut16[(uint32_t)in[slot] << 8 | in[slot + 1]];
+            value = ((value * gain[slot]) >> 15) * scale >> 15;
+            out[slot] = (uint8_t)(value >> 8);
+            out[slot + 1] = (uint8_t)value;
+        }
+    }
+}
+
+}
@@ -0,0 +1,109 @@
+#ifndef OUTPUT_STAGE_HPP
+#define OUTPUT_STAGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace gacn {
+
+// Per-universe output processing applied once per transmitted packet:
+// transfer curve (gamma or custom) through precomputed 8-bit and 16-bit LUTs,
+// per-channel calibration gains, group and master dimmers and optional
+// temporal dithering for 8-bit channels.
+//
+// Configuration calls come from the main thread and rebuild immutable
+// profiles; process() runs on sender threads, picks up a new snapshot only
+// when the configuration version changes and never allocates in the steady
+// state. Each sending thread passes its own ThreadState, so several threads
+// can process different universes at once.
+class OutputStage {
+public:
+    static const int MAX_GROUPS = 64;
+    static const int MAX_UNIVERSES = 64000;
+
+    class ThreadState;
+
+    OutputStage();
+    ~OutputStage();
+
+    OutputStage(const OutputStage &) = delete;
+    OutputStage &operator=(const OutputStage &) = delete;
+
+    // Configuration, any thread.
+    void set_master_dimmer(float value);
+    float get_master_dimmer() const;
+    void set_group_dimmer(int group, float value);
+    float get_group_dimmer(int group) const;
+    void set_dithering(bool enabled);
+    bool get_dithering() const;
+
+    void set_universe_group(uint16_t universe, int group);
+    void set_universe_gamma(uint16_t universe, float gamma);
+    // Transfer curve sampled evenly over [0, 1], linearly interpolated.
+    void set_universe_curve(uint16_t universe, const float *points, size_t count);
+    // Slot indices of the coarse byte of each 16-bit channel pair.
+    void set_universe_wide_channels(uint16_t universe, const uint16_t *slots, size_t count);
+    // Calibration gains in [0, 1] for slots [first_slot, first_slot + count).
+    void set_channel_gains(uint16_t universe, uint16_t first_slot, const float *gains, size_t count);
+    void clear_universe(uint16_t universe);
+
+    // Sender threads; a universe must always be processed with the same state.
+    void process(ThreadState &state, uint16_t universe, const uint8_t *in, uint8_t *out, uint16_t length);
+
+private:
+    struct UniverseConfig {
+        int group = 0;
+        std::vector<float> curve; // empty = gamma
+        float gamma = 1.0f;
+        std::vector<uint16_t> wide_slots;
+        std::vector<float> gains;
+    };
+
+    // Immutable once published.
+    struct Profile {
+        int group = 0;
+        bool identity = true; // linear curve, unity gains, no wide channels
+        uint16_t lut8[256]; // 8.8 fixed point
+        std::vector<uint16_t> lut16; // 65536 entries when wide_slots is set
+        std::vector<uint16_t> wide_slots;
+        uint16_t gain[512]; // Q1.15
+    };
+
+    typedef std::unordered_map<uint16_t, std::shared_ptr<const Profile>> ProfileTable;
+
+    // Main thread side. published is swapped with std::atomic_store.
+    std::mutex config_mtx;
+    std::map<uint16_t, UniverseConfig> configs;
+    std::shared_ptr<const ProfileTable> published;
+    Profile identity_profile;
+    std::atomic<uint32_t> version{ 0 };
+
+    std::atomic<float> master_dimmer{ 1.0f };
+    std::atomic<float> group_dimmers[MAX_GROUPS];
+    std::atomic<bool> dithering{ false };
+    // 512 bytes per universe, allocated the first time dithering is enabled
+    // and kept until destruction. Zero pages stay unbacked until a universe
+    // is dithered.
+    std::atomic<uint8_t *> dither_residuals{ nullptr };
+
+    std::shared_ptr<const Profile> _build_profile(const UniverseConfig &config) const;
+    void _publish(uint16_t universe);
+
+public:
+    // Profile snapshot owned by one sending thread.
+    class ThreadState {
+        friend class OutputStage;
+        uint32_t seen_version = 0;
+        std::shared_ptr<const ProfileTable> current;
+    };
+};
+
+}
+
+#endif
@@ -0,0 +1,520 @@
+#include "pcap_file.hpp"
+
+#include "sacn_log.hpp"
+
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace gacn {
+
+static const uint32_t PCAP_MAGIC_US = 0xa1b2c3d4;
+static const uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;
+static const uint32_t PCAPNG_SECTION_HEADER = 0x0a0d0d0a;
+static const uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1a2b3c4d;
+static const uint32_t PCAPNG_INTERFACE_DESCRIPTION = 1;
+static const uint32_t PCAPNG_OBSOLETE_PACKET = 2;
+static const uint32_t PCAPNG_SIMPLE_PACKET = 3;
+static const uint32_t PCAPNG_ENHANCED_PACKET = 6;
+static const uint16_t PCAPNG_OPTION_TSRESOL = 9;
+
+static const uint32_t LINKTYPE_NULL = 0;
+static const uint32_t LINKTYPE_ETHERNET = 1;
+static const uint32_t LINKTYPE_RAW_BSD = 12;
+static const uint32_t LINKTYPE_RAW_OPENBSD = 14;
+static const uint32_t LINKTYPE_RAW = 101;
+static const uint32_t LINKTYPE_LOOP = 108;
+static const uint32_t LINKTYPE_LINUX_SLL = 113;
+static const uint32_t LINKTYPE_IPV4 = 228;
+static const uint32_t LINKTYPE_LINUX_SLL2 = 276;
+
+static const size_t STDIO_BUFFER_SIZE = 1 << 20;
+// Larger records or blocks mean the file is damaged.
+static const uint32_t MAX_RECORD_SIZE = 1 << 18;
+static const uint32_t MAX_BLOCK_SIZE = 1 << 24;
+
+PACK(struct PcapFileHeader {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+});
+
+PACK(struct PcapRecordHeader {
+    uint32_t ts_sec;
+    uint32_t ts_nsec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+});
+
+PACK(struct Ipv4UdpHeader {
+    uint8_t version_ihl;
+    uint8_t tos;
+    uint16_t total_length;
+    uint16_t id;
+    uint16_t flags_fragment;
+    uint8_t ttl;
+    uint8_t protocol;
+    uint16_t checksum;
+    uint32_t src;
+    uint32_t dst;
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint16_t udp_length;
+    uint16_t udp_checksum;
+});
+
+uint64_t realtime_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint16_t ipv4_checksum(const uint8_t *data, size_t length) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        sum += (uint32_t)data[i] << 8 | data[i + 1];
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return htons((uint16_t)~sum);
+}
+
+PcapWriter::PcapWriter() {
+}
+
+PcapWriter::~PcapWriter() {
+    close();
+}
+
+bool PcapWriter::open(const char *path) {
+    close();
+    file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        log_error("PcapWriter: cannot open %s: %s", path, strerror(errno));
+        return false;
+    }
+    buffer = (char *)std::malloc(STDIO_BUFFER_SIZE);
+    if (buffer != nullptr) {
+        std::setvbuf(file, buffer, _IOFBF, STDIO_BUFFER_SIZE);
+    }
+
+    PcapFileHeader header;
+    header.magic = PCAP_MAGIC_NS;
+    header.version_major = 2;
+    header.version_minor = 4;
+    header.thiszone = 0;
+    header.sigfigs = 0;
+    header.snaplen = 65535;
+    header.linktype = LINKTYPE_RAW;
+    return std::fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+void PcapWriter::close() {
+    if (file != nullptr) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    std::free(buffer);
+    buffer = nullptr;
+}
+
+bool PcapWriter::is_open() const {
+    return file != nullptr;
+}
+
+bool PcapWriter::write(const uint8_t *payload, size_t length, const e131_addr_t &from, const e131_addr_t &to, uint64_t timestamp_ns) {
+    if (file == nullptr) {
+        return false;
+    }
+
+    Ipv4UdpHeader ip;
+    std::memset(&ip, 0, sizeof(ip));
+    ip.version_ihl = 0x45;
+    ip.total_length = htons((uint16_t)(sizeof(ip) + length));
+    ip.id = htons(ip_id++);
+    ip.ttl = 64;
+    ip.protocol = 17; // UDP
+    ip.src = from.sin_addr.s_addr;
+    ip.dst = to.sin_addr.s_addr;
+    ip.checksum = ipv4_checksum((const uint8_t *)&ip, 20);
+    ip.src_port = from.sin_port;
+    ip.dst_port = to.sin_port;
+    ip.udp_length = htons((uint16_t)(8 + length));
+    ip.udp_checksum = 0; // optional for IPv4
+
+    PcapRecordHeader record;
+    record.ts_sec = (uint32_t)(timestamp_ns / 1000000000ull);
+    record.ts_nsec = (uint32_t)(timestamp_ns % 1000000000ull);
+    record.incl_len = (uint32_t)(sizeof(ip) + length);
+    record.orig_len = record.incl_len;
+
+    return std::fwrite(&record, sizeof(record), 1, file) == 1 &&
+            std::fwrite(&ip, sizeof(ip), 1, file) == 1 &&
+            std::fwrite(payload, length, 1, file) == 1;
+}
+
+void PcapWriter::flush() {
+    if (file != nullptr) {
+        std::fflush(file);
+    }
+}
+
+PcapReader::PcapReader() {
+}
+
+PcapReader::~PcapReader() {
+    close();
+}
+
+static uint16_t read_be16(const uint8_t *p) {
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+uint16_t PcapReader::_u16(const uint8_t *p) const {
+    uint16_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return swapped ? __builtin_bswap16(value) : value;
+}
+
+uint32_t PcapReader::_u32(const uint8_t *p) const {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return swapped ? __builtin_bswap32(value) : value;
+}
+
+bool PcapReader::open(const char *path) {
+    close();
+    file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        log_error("PcapReader: cannot open %s: %s", path, strerror(errno));
+        return false;
+    }
+    buffer = (char *)std::malloc(STDIO_BUFFER_SIZE);
+    if (buffer != nullptr) {
+        std::setvbuf(file, buffer, _IOFBF, STDIO_BUFFER_SIZE);
+    }
+
+    uint8_t header[24];
+    if (!_read(header, 8, false)) {
+        close();
+        return false;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, header, sizeof(magic));
+    if (magic == PCAPNG_SECTION_HEADER) {
+        format = FORMAT_PCAPNG;
+        if (!_read_section_header(header + 4)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    format = FORMAT_PCAP;
+    swapped = magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS;
+    magic = _u32(header);
+    if (magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS) {
+        log_error("PcapReader: %s is not a pcap or pcapng capture", path);
+        close();
+        return false;
+    }
+    if (!_read(header + 8, sizeof(header) - 8, false)) {
+        close();
+        return false;
+    }
+    // The upper bits of the link type field carry FCS information.
+    Interface interface;
+    interface.linktype = _u32(header + 20) & 0xffff;
+    interface.units_per_second = magic == PCAP_MAGIC_NS ? 1000000000ull : 1000000ull;
+    interfaces.push_back(interface);
+    return true;
+}
+
+void PcapReader::close() {
+    if (file != nullptr) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    std::free(buffer);
+    buffer = nullptr;
+    swapped = false;
+    interfaces.clear();
+    last_timestamp_ns = 0;
+    frames = 0;
+    skipped = 0;
+}
+
+bool PcapReader::is_open() const {
+    return file != nullptr;
+}
+
+uint64_t PcapReader::get_frame_count() const {
+    return frames;
+}
+
+uint64_t PcapReader::get_skipped_count() const {
+    return skipped;
+}
+
+bool PcapReader::next(Datagram &out) {
+    if (file == nullptr) {
+        return false;
+    }
+    for (;;) {
+        const uint8_t *frame;
+        size_t length;
+        uint32_t linktype;
+        if (!(format == FORMAT_PCAP ? _next_pcap(frame, length, linktype) : _next_pcapng(frame, length, linktype))) {
+            return false;
+        }
+        frames++;
+        if (_extract_udp(frame, length, linktype, out)) {
+            out.timestamp_ns = last_timestamp_ns;
+            return true;
+        }
+        skipped++;
+    }
+}
+
+bool PcapReader::_read(void *out, size_t length, bool end_ok) {
+    const size_t got = std::fread(out, 1, length, file);
+    if (got == length) {
+        return true;
+    }
+    if (got != 0 || !end_ok) {
+        log_error("PcapReader: capture is truncated");
+    }
+    return false;
+}
+
+static uint64_t to_ns(uint64_t timestamp, uint64_t units_per_second) {
+    return timestamp / units_per_second * 1000000000ull +
+            (uint64_t)((double)(timestamp % units_per_second) * 1e9 / (double)units_per_second);
+}
+
+bool PcapReader::_next_pcap(const uint8_t *&frame, size_t &length, uint32_t &linktype) {
+    uint8_t header[sizeof(PcapRecordHeader)];
+    if (!_read(header, sizeof(header), true)) {
+        return false;
+    }
+    const uint32_t captured = _u32(header + 8);
+    if (captured > MAX_RECORD_SIZE) {
+        log_error("PcapReader: damaged record of %u bytes", captured);
+        return false;
+    }
+    record.resize(captured);
+    if (!_read(record.data(), captured, false)) {
+        return false;
+    }
+    const uint64_t units = interfaces[0].units_per_second;
+    last_timestamp_ns = to_ns((uint64_t)_u32(header) * units + _u32(header + 4), units);
+    frame = record.data();
+    length = captured;
+    linktype = interfaces[0].linktype;
+    return true;
+}
+
+bool PcapReader::_read_section_header(const uint8_t *length_bytes) {
+    uint8_t order[4];
+    if (!_read(order, sizeof(order), false)) {
+        return false;
+    }
+    uint32_t magic;
+    std::memcpy(&magic, order, sizeof(magic));
+    if (magic != PCAPNG_BYTE_ORDER_MAGIC && __builtin_bswap32(magic) != PCAPNG_BYTE_ORDER_MAGIC) {
+        log_error("PcapReader: damaged pcapng section header");
+        return false;
+    }
+    // Every section has its own byte order and interfaces.
+    swapped = magic != PCAPNG_BYTE_ORDER_MAGIC;
+    interfaces.clear();
+    const uint32_t total = _u32(length_bytes);
+    if (total < 28 || total % 4 != 0 || total > MAX_BLOCK_SIZE) {
+        log_error("PcapReader: damaged pcapng section header");
+        return false;
+    }
+    record.resize(total - 12);
+    return _read(record.data(), record.size(), false);
+}
+
+void PcapReader::_add_interface(const uint8_t *body, size_t length) {
+    Interface interface;
+    interface.linktype = length >= 2 ? _u16(body) : 0xffff;
+    interface.units_per_second = 1000000ull;
+    for (size_t pos = 8; pos + 4 <= length;) {
+        const uint16_t code = _u16(body + pos);
+        const uint16_t option_length = _u16(body + pos + 2);
+        pos += 4;
+        if (code == 0 || pos + option_length > length) {
+            break;
+        }
+        if (code == PCAPNG_OPTION_TSRESOL && option_length >= 1) {
+            // Negative power of two with the top bit set, of ten otherwise.
+            const uint8_t resolution = body[pos];
+            const int exponent = resolution & 0x7f;
+            if (resolution & 0x80) {
+                interface.units_per_second = 1ull << std::min(exponent, 63);
+            } else {
+                interface.units_per_second = 1;
+                for (int i = 0; i < std::min(exponent, 19); ++i) {
+                    interface.units_per_second *= 10;
+                }
+            }
+        }
+        pos += (option_length + 3u) & ~3u;
+    }
+    interfaces.push_back(interface);
+}
+
+bool PcapReader::_next_pcapng(const uint8_t *&frame, size_t &length, uint32_t &linktype) {
+    for (;;) {
+        uint8_t header[8];
+        if (!_read(header, sizeof(header), true)) {
+            return false;
+        }
+        uint32_t type;
+        std::memcpy(&type, header, sizeof(type));
+        if (type == PCAPNG_SECTION_HEADER) {
+            if (!_read_section_header(header + 4)) {
+                return false;
+            }
+            continue;
+        }
+        type = _u32(header);
+        const uint32_t total = _u32(header + 4);
+        if (total < 12 || total % 4 != 0 || total > MAX_BLOCK_SIZE) {
+            log_error("PcapReader: damaged pcapng block of %u bytes", total);
+            return false;
+        }
+        // The body, then the repeated block length.
+        record.resize(total - 8);
+        if (!_read(record.data(), record.size(), false)) {
+            return false;
+        }
+        const uint8_t *body = record.data();
+        const size_t body_length = total - 12;
+
+        if (type == PCAPNG_INTERFACE_DESCRIPTION) {
+            _add_interface(body, body_length);
+            continue;
+        }
+        if (type == PCAPNG_SIMPLE_PACKET) {
+            // No interface or timestamp of its own: interface 0, previous time.
+            if (body_length < 4 || interfaces.empty()) {
+                continue;
+            }
+            frame = body + 4;
+            length = std::min<size_t>(_u32(body), body_length - 4);
+            linktype = interfaces[0].linktype;
+            return true;
+        }
+        if (type == PCAPNG_ENHANCED_PACKET || type == PCAPNG_OBSOLETE_PACKET) {
+            if (body_length < 20) {
+                continue;
+            }
+            const uint32_t interface = type == PCAPNG_ENHANCED_PACKET ? _u32(body) : _u16(body);
+            const uint32_t captured = _u32(body + 12);
+            if (interface >= interfaces.size() || captured > body_length - 20) {
+                log_error("PcapReader: damaged pcapng packet block");
+                return false;
+            }
+            const uint64_t timestamp = (uint64_t)_u32(body + 4) << 32 | _u32(body + 8);
+            last_timestamp_ns = to_ns(timestamp, interfaces[interface].units_per_second);
+            frame = body + 20;
+            length = captured;
+            linktype = interfaces[interface].linktype;
+            return true;
+        }
+        // Statistics, name resolution, comments and custom blocks.
+    }
+}
+
+bool PcapReader::_extract_udp(const uint8_t *frame, size_t length, uint32_t linktype, Datagram &out) const {
+    size_t offset = 0;
+    uint16_t ethertype = 0x0800;
+    switch (linktype) {
+        case LINKTYPE_ETHERNET:
+            if (length < 14) {
+                return false;
+            }
+            ethertype = read_be16(frame + 12);
+            offset = 14;
+            while (ethertype == 0x8100 || ethertype == 0x88a8) {
+                if (length < offset + 4) {
+                    return false;
+                }
+                ethertype = read_be16(frame + offset + 2);
+                offset += 4;
+            }
+            break;
+        case LINKTYPE_NULL:
+        case LINKTYPE_LOOP:
+            // Address family in the capturing host's byte order; the IP
+            // version check below is enough.
+            offset = 4;
+            break;
+        case LINKTYPE_RAW:
+        case LINKTYPE_RAW_BSD:
+        case LINKTYPE_RAW_OPENBSD:
+        case LINKTYPE_IPV4:
+            break;
+        case LINKTYPE_LINUX_SLL:
+            if (length < 16) {
+                return false;
+            }
+            ethertype = read_be16(frame + 14);
+            offset = 16;
+            break;
+        case LINKTYPE_LINUX_SLL2:
+            if (length < 20) {
+                return false;
+            }
+            ethertype = read_be16(frame);
+            offset = 20;
+            break;
+        default:
+            return false;
+    }
+    if (ethertype != 0x0800 || length < offset + 20) {
+        return false;
+    }
+
+    const uint8_t *ip = frame + offset;
+    const size_t available = length - offset;
+    const size_t header_length = (size_t)(ip[0] & 0x0f) * 4;
+    if (ip[0] >> 4 != 4 || header_length < 20 || available < header_length + 8 || ip[9] != 17) {
+        return false;
+    }
+    // E1.31 packets fit one datagram; fragments are not reassembled.
+    if (read_be16(ip + 6) & 0x3fff) {
+        return false;
+    }
+    const uint8_t *udp = ip + header_length;
+    const uint16_t udp_length = read_be16(udp + 4);
+    if (udp_length < 8) {
+        return false;
+    }
+
+    std::memset(&out.from, 0, sizeof(out.from));
+    out.from.sin_family = AF_INET;
+    std::memcpy(&out.from.sin_addr.s_addr, ip + 12, 4);
+    std::memcpy(&out.from.sin_port, udp, 2);
+    std::memset(&out.to, 0, sizeof(out.to));
+    out.to.sin_family = AF_INET;
+    std::memcpy(&out.to.sin_addr.s_addr, ip + 16, 4);
+    std::memcpy(&out.to.sin_port, udp + 2, 2);
+    out.payload = udp + 8;
+    // A short snap length cuts the payload; validation rejects it later.
+    out.length = std::min<size_t>(udp_length - 8, available - header_length - 8);
+    return true;
+}
+
+}
@@ -0,0 +1,105 @@
+#ifndef PCAP_FILE_HPP
+#define PCAP_FILE_HPP
+
+#include "e131.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace gacn {
+
+// Writes received E1.31 datagrams as a classic libpcap capture (LINKTYPE_RAW,
+// synthesized IPv4/UDP headers) so recordings open in Wireshark and can be
+// replayed later. Writes go through a large stdio buffer; nothing is
+// allocated per packet.
+class PcapWriter {
+public:
+    PcapWriter();
+    ~PcapWriter();
+
+    PcapWriter(const PcapWriter &) = delete;
+    PcapWriter &operator=(const PcapWriter &) = delete;
+
+    bool open(const char *path);
+    void close();
+    bool is_open() const;
+
+    // from is the sender, to the local destination (port and address).
+    bool write(const uint8_t *payload, size_t length, const e131_addr_t &from, const e131_addr_t &to, uint64_t timestamp_ns);
+    void flush();
+
+private:
+    FILE *file = nullptr;
+    char *buffer = nullptr;
+    uint16_t ip_id = 0;
+};
+
+// Reads IPv4 UDP datagrams back out of a capture: classic libpcap (micro- or
+// nanosecond, either byte order) or pcapng, on Ethernet (with VLAN tags),
+// raw IP, Linux cooked (v1 and v2) and BSD loopback links. Anything else,
+// including IP fragments, is skipped and counted. Records are read into one
+// reused buffer.
+class PcapReader {
+public:
+    struct Datagram {
+        const uint8_t *payload; // valid until the next call
+        size_t length;
+        e131_addr_t from;
+        e131_addr_t to;
+        uint64_t timestamp_ns; // capture time since the epoch
+    };
+
+    PcapReader();
+    ~PcapReader();
+
+    PcapReader(const PcapReader &) = delete;
+    PcapReader &operator=(const PcapReader &) = delete;
+
+    bool open(const char *path);
+    void close();
+    bool is_open() const;
+
+    // Returns false at the end of the capture or on a damaged record, which
+    // is logged.
+    bool next(Datagram &out);
+
+    uint64_t get_frame_count() const; // records read
+    uint64_t get_skipped_count() const; // records that were not IPv4 UDP
+
+private:
+    enum Format {
+        FORMAT_PCAP,
+        FORMAT_PCAPNG,
+    };
+    struct Interface {
+        uint32_t linktype;
+        uint64_t units_per_second;
+    };
+
+    FILE *file = nullptr;
+    char *buffer = nullptr;
+    Format format = FORMAT_PCAP;
+    bool swapped = false;
+    std::vector<Interface> interfaces; // one for classic pcap
+    std::vector<uint8_t> record;
+    uint64_t last_timestamp_ns = 0;
+    uint64_t frames = 0;
+    uint64_t skipped = 0;
+
+    uint16_t _u16(const uint8_t *p) const;
+    uint32_t _u32(const uint8_t *p) const;
+    bool _read(void *out, size_t length, bool end_ok);
+    bool _next_pcap(const uint8_t *&frame, size_t &length, uint32_t &linktype);
+    bool _next_pcapng(const uint8_t *&frame, size_t &length, uint32_t &linktype);
+    bool _read_section_header(const uint8_t *length_bytes);
+    void _add_interface(const uint8_t *body, size_t length);
+    bool _extract_udp(const uint8_t *frame, size_t length, uint32_t linktype, Datagram &out) const;
+};
+
+// CLOCK_REALTIME in nanoseconds, for capture timestamps.
+uint64_t realtime_ns();
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include "pcap_replay.hpp"
+
+#include "sacn_log.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+
+namespace gacn {
+
+PcapReplay::PcapReplay() {
+}
+
+PcapReplay::~PcapReplay() {
+    stop();
+}
+
+bool PcapReplay::start(ReceiverEngine &p_engine, const Config &p_config) {
+    stop();
+    if (!reader.open(p_config.path.c_str())) {
+        return false;
+    }
+    config = p_config;
+    engine = &p_engine;
+
+    frames = 0;
+    skipped = 0;
+    other_port = 0;
+    fed = 0;
+    capture_ns = 0;
+    finished = false;
+    start_ns = monotonic_ns();
+    stop_ns = 0;
+    if (config.speed > 0.0) {
+        log_info("PcapReplay: replaying %s at %.2fx", config.path.c_str(), config.speed);
+    } else {
+        log_info("PcapReplay: replaying %s as fast as possible", config.path.c_str());
+    }
+    running = true;
+    thread = std::thread(&PcapReplay::_thread_func, this);
+    return true;
+}
+
+void PcapReplay::stop() {
+    // The thread also ends by itself at the end of the capture.
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    reader.close();
+}
+
+bool PcapReplay::is_running() const {
+    return running.load();
+}
+
+PcapReplay::Report PcapReplay::get_report() const {
+    Report report;
+    const uint64_t started = start_ns.load();
+    const uint64_t stopped = stop_ns.load();
+    const uint64_t end_ns = stopped != 0 ? stopped : monotonic_ns();
+    report.elapsed = started != 0 ? (double)(end_ns - started) * 1e-9 : 0.0;
+    report.capture_time = (double)capture_ns.load(std::memory_order_relaxed) * 1e-9;
+    report.frames = frames.load(std::memory_order_relaxed);
+    report.skipped = skipped.load(std::memory_order_relaxed);
+    report.other_port = other_port.load(std::memory_order_relaxed);
+    report.fed = fed.load(std::memory_order_relaxed);
+    report.packet_rate = report.elapsed > 0.0 ? (double)report.fed / report.elapsed : 0.0;
+    report.finished = finished.load();
+    return report;
+}
+
+void PcapReplay::_thread_func() {
+    const uint64_t base_ns = start_ns.load();
+    uint64_t first_ns = 0;
+    uint64_t offset_ns = 0;
+    PcapReader::Datagram datagram;
+
+    while (running.load(std::memory_order_relaxed)) {
+        if (!reader.next(datagram)) {
+            finished = true;
+            break;
+        }
+        frames.store(reader.get_frame_count(), std::memory_order_relaxed);
+        skipped.store(reader.get_skipped_count(), std::memory_order_relaxed);
+        if (config.port != 0 && ntohs(datagram.to.sin_port) != config.port) {
+            other_port.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        // Captures from several interfaces can be slightly out of order;
+        // never let the clock run backwards.
+        if (first_ns == 0) {
+            first_ns = datagram.timestamp_ns;
+        }
+        if (datagram.timestamp_ns > first_ns) {
+            offset_ns = std::max(offset_ns, datagram.timestamp_ns - first_ns);
+        }
+        capture_ns.store(offset_ns, std::memory_order_relaxed);
+
+        if (config.speed > 0.0) {
+            const uint64_t due_ns = base_ns + (uint64_t)((double)offset_ns / config.speed);
+            for (uint64_t now = monotonic_ns(); now < due_ns && running.load(std::memory_order_relaxed); now = monotonic_ns()) {
+                // Short naps so stop() is never held up by a long gap.
+                std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<uint64_t>(due_ns - now, 50000000ull)));
+            }
+        }
+
+        engine->feed(datagram.payload, datagram.length, datagram.from, datagram.to, base_ns + offset_ns);
+        fed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    stop_ns = monotonic_ns();
+    running = false;
+    if (finished.load()) {
+        log_info("PcapReplay: %s finished, %llu datagrams fed", config.path.c_str(), (unsigned long long)fed.load());
+    }
+}
+
+}
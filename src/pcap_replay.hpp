@@ -0,0 +1,80 @@
+#ifndef PCAP_REPLAY_HPP
+#define PCAP_REPLAY_HPP
+
+#include "e131.h"
+#include "pcap_file.hpp"
+#include "receiver_engine.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace gacn {
+
+// Feeds the E1.31 datagrams of a capture into a ReceiverEngine from a thread
+// of its own, so recorded traffic takes the same validation, sequencing,
+// merge and delivery path as live traffic, without a network.
+//
+// A running engine is fed on the real clock and keeps its joined-universe
+// filter. A stopped engine runs on the capture's clock instead, so source
+// timeouts and fades happen as recorded even at full speed. The engine
+// decides per datagram, so it may be restarted during a replay.
+class PcapReplay {
+public:
+    struct Config {
+        std::string path;
+        // 1 plays with the recorded timing, 2 twice as fast; 0 or less feeds
+        // as fast as the pipeline takes it.
+        double speed = 1.0;
+        // Destination port of the datagrams to feed; 0 takes every port.
+        uint16_t port = E131_DEFAULT_PORT;
+    };
+
+    struct Report {
+        double elapsed = 0.0; // seconds since start
+        double capture_time = 0.0; // seconds of capture fed so far
+        uint64_t frames = 0; // capture records read
+        uint64_t skipped = 0; // records that were not IPv4 UDP
+        uint64_t other_port = 0; // UDP datagrams to another port
+        uint64_t fed = 0; // datagrams handed to the engine
+        double packet_rate = 0.0; // fed per second
+        bool finished = false; // reached the end of the capture
+    };
+
+    PcapReplay();
+    ~PcapReplay();
+
+    PcapReplay(const PcapReplay &) = delete;
+    PcapReplay &operator=(const PcapReplay &) = delete;
+
+    // The engine must outlive the replay. Fails if the capture cannot be
+    // opened.
+    bool start(ReceiverEngine &p_engine, const Config &p_config);
+    void stop();
+    bool is_running() const;
+
+    Report get_report() const;
+
+private:
+    Config config;
+    ReceiverEngine *engine = nullptr;
+    PcapReader reader;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    std::atomic<bool> finished{ false };
+    std::atomic<uint64_t> start_ns{ 0 };
+    std::atomic<uint64_t> stop_ns{ 0 };
+
+    std::atomic<uint64_t> frames{ 0 };
+    std::atomic<uint64_t> skipped{ 0 };
+    std::atomic<uint64_t> other_port{ 0 };
+    std::atomic<uint64_t> fed{ 0 };
+    std::atomic<uint64_t> capture_ns{ 0 };
+
+    void _thread_func();
+};
+
+}
+
+#endif
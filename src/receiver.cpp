@@ -1,4 +1,5 @@
 #include "receiver.hpp"
+#include "server.hpp"
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -8,6 +9,9 @@
 #include <string.h> // For strerror
 #include <errno.h>  // For errno
 #include <arpa/inet.h> // For inet_ntop
+#include <stdio.h> // For snprintf
+#include <algorithm>
+#include <vector>
 
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
@@ -16,48 +20,206 @@
 using namespace godot;
 
 #include <godot_cpp/classes/engine.hpp> // Include for Engine::get_singleton()->is_editor_hint()
+#include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/classes/os.hpp> // Include for OS::get_singleton()->get_process_id()
 #include <godot_cpp/classes/display_server.hpp> // Include for DisplayServer::get_singleton()->window_set_mode()
 
 void SacnReceiver::_bind_methods() {
-    ClassDB::bind_method(D_METHOD("activate_universe", "universe_id"), &SacnReceiver::activate_universe);
+    ClassDB::bind_method(D_METHOD("activate_universe", "universe_id", "interface"), &SacnReceiver::activate_universe, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("activate_universe_range", "first_universe", "count", "interface"), &SacnReceiver::activate_universe_range, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("get_universe_interface", "universe_id"), &SacnReceiver::get_universe_interface);
+    ClassDB::bind_method(D_METHOD("is_universe_active", "universe_id"), &SacnReceiver::is_universe_active);
+
+    ClassDB::bind_method(D_METHOD("set_local_transport", "enable"), &SacnReceiver::set_local_transport);
+    ClassDB::bind_method(D_METHOD("get_local_transport"), &SacnReceiver::get_local_transport);
+    ClassDB::add_property("SacnReceiver", PropertyInfo(Variant::BOOL, "local_transport"), "set_local_transport", "get_local_transport");
+
+    ClassDB::bind_method(D_METHOD("get_changed_ranges", "universe_id"), &SacnReceiver::get_changed_ranges);
+    ClassDB::bind_method(D_METHOD("get_dirty_mask", "universe_id"), &SacnReceiver::get_dirty_mask);
+
+    ClassDB::bind_method(D_METHOD("set_delivery_mode", "mode"), &SacnReceiver::set_delivery_mode);
+    ClassDB::bind_method(D_METHOD("get_delivery_mode"), &SacnReceiver::get_delivery_mode);
+    ClassDB::add_property("SacnReceiver", PropertyInfo(Variant::INT, "delivery_mode", PROPERTY_HINT_ENUM, "Per Universe,Frame,Both"), "set_delivery_mode", "get_delivery_mode");
+
+    ClassDB::bind_method(D_METHOD("replay_capture", "path", "speed"), &SacnReceiver::replay_capture, DEFVAL(1.0));
+    ClassDB::bind_method(D_METHOD("stop_replay"), &SacnReceiver::stop_replay);
+    ClassDB::bind_method(D_METHOD("is_replaying"), &SacnReceiver::is_replaying);
+    ClassDB::bind_method(D_METHOD("get_replay_report"), &SacnReceiver::get_replay_report);
 
     ClassDB::bind_method(D_METHOD("set_preview", "enable"), &SacnReceiver::set_preview);
     ClassDB::bind_method(D_METHOD("is_preview"), &SacnReceiver::is_preview);
     ClassDB::add_property("SacnReceiver", PropertyInfo(Variant::BOOL, "preview"), "set_preview", "is_preview");
 
     ClassDB::add_signal(get_class_static(), MethodInfo("data_received", PropertyInfo(Variant::INT, "universe_id"), PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data")));
+    ClassDB::add_signal(get_class_static(), MethodInfo("frame_received", PropertyInfo(Variant::PACKED_INT32_ARRAY, "universes"), PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data")));
+    ClassDB::add_signal(get_class_static(), MethodInfo("source_lost", PropertyInfo(Variant::STRING, "cid"), PropertyInfo(Variant::INT, "universe_id"), PropertyInfo(Variant::BOOL, "terminated")));
+    ClassDB::add_signal(get_class_static(), MethodInfo("universe_lost", PropertyInfo(Variant::INT, "universe_id")));
 
     // _process, _notification, and _exit_tree are virtual methods and are automatically bound by Godot.
     // No need to explicitly bind them here.
     ClassDB::bind_method(D_METHOD("_notification", "what"), &SacnReceiver::_notification);
 }
 
-SacnReceiver::SacnReceiver() : running(false) {
-    sockfd = -1;
+SacnReceiver::SacnReceiver() : engine(SacnServer::get_singleton()->get_receiver_engine()) {
 }
 
 SacnReceiver::~SacnReceiver() {
     _exit(); // Ensure cleanup on destruction
+    if (local_transport && SacnServer::get_singleton() != nullptr) {
+        SacnServer::get_singleton()->release_receiver_local_transport();
+    }
 }
 
-void SacnReceiver::activate_universe(uint16_t universe_id) {
-    if (sockfd < 0) {
+void SacnReceiver::activate_universe(uint16_t universe_id, int interface) {
+    SacnServer *server = SacnServer::get_singleton();
+    if (!server->is_attached(this)) {
         UtilityFunctions::print("SacNReceiver: Socket not initialized. Cannot activate universe ", universe_id);
         return;
     }
 
-    if(active_universes.find(universe_id) != active_universes.end()) {
+    if (server->is_subscribed(this, universe_id) && engine.get_memberships().get_joined_interface(universe_id) == interface) {
         return;
     }
-    if (e131_multicast_join_iface(sockfd, universe_id, 0) < 0) {
-        UtilityFunctions::printerr("SacNReceiver: e131_multicast_join_iface failed for universe ", universe_id, ": ", strerror(errno));
-    } else {
+    if (server->subscribe(this, universe_id, interface)) {
         UtilityFunctions::print("SacNReceiver: Joined multicast group for universe ", universe_id);
-        active_universes.insert(universe_id);
     }
 }
 
+int SacnReceiver::activate_universe_range(int first_universe, int count, int interface) {
+    SacnServer *server = SacnServer::get_singleton();
+    if (!server->is_attached(this)) {
+        UtilityFunctions::print("SacNReceiver: Socket not initialized. Cannot activate universes ", first_universe, "-", first_universe + count - 1);
+        return 0;
+    }
+    if (first_universe < 1 || first_universe > 63999 || count < 0) {
+        UtilityFunctions::printerr("SacNReceiver: invalid universe range ", first_universe, " + ", count);
+        return 0;
+    }
+
+    int joined = server->subscribe_range(this, first_universe, count, interface);
+    if (joined < count) {
+        gacn::MembershipManager::Capacity capacity = engine.get_memberships().get_capacity();
+        UtilityFunctions::printerr("SacNReceiver: joined only ", joined, " of ", count, " universes; ", capacity.joined, "/", capacity.capacity,
+                " memberships in use (", capacity.sockets, "/", capacity.max_sockets, " sockets, ", capacity.per_socket, " per socket)");
+    } else {
+        UtilityFunctions::print("SacNReceiver: Joined multicast groups for universes ", first_universe, "-", first_universe + count - 1);
+    }
+    return joined;
+}
+
+bool SacnReceiver::is_universe_active(int universe_id) const {
+    if (universe_id < 1 || universe_id > 63999) {
+        return false;
+    }
+    return SacnServer::get_singleton()->is_subscribed(this, universe_id);
+}
+
+int SacnReceiver::get_universe_interface(int universe_id) const {
+    if (!is_universe_active(universe_id)) {
+        return -1;
+    }
+    return engine.get_memberships().get_joined_interface(universe_id);
+}
+
+void SacnReceiver::set_local_transport(bool p_enable) {
+    if (local_transport == p_enable) {
+        return;
+    }
+    local_transport = p_enable;
+    // Counted per receiver, so one receiver turning it off leaves it on for
+    // the others.
+    if (p_enable) {
+        SacnServer::get_singleton()->acquire_receiver_local_transport();
+    } else {
+        SacnServer::get_singleton()->release_receiver_local_transport();
+    }
+}
+
+bool SacnReceiver::get_local_transport() const {
+    return local_transport;
+}
+
+const SacnReceiver::Delivered *SacnReceiver::_get_current_delivery(int universe_id) const {
+    auto it = delivered.find((uint16_t)universe_id);
+    if (universe_id < 1 || universe_id > 63999 || it == delivered.end() || it->second.frame != frame_number) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+PackedInt32Array SacnReceiver::get_changed_ranges(int universe_id) {
+    PackedInt32Array result;
+    const Delivered *entry = _get_current_delivery(universe_id);
+    if (entry == nullptr) {
+        return result;
+    }
+    range_scratch.clear();
+    gacn::mask_to_ranges(entry->changed, range_scratch);
+    result.resize(range_scratch.size());
+    if (!range_scratch.empty()) {
+        memcpy(result.ptrw(), range_scratch.data(), range_scratch.size() * sizeof(int32_t));
+    }
+    return result;
+}
+
+PackedByteArray SacnReceiver::get_dirty_mask(int universe_id) const {
+    PackedByteArray result;
+    result.resize(64);
+    uint8_t *bytes = result.ptrw();
+    memset(bytes, 0, 64);
+    const Delivered *entry = _get_current_delivery(universe_id);
+    if (entry == nullptr) {
+        return result;
+    }
+    // Bit (slot & 7) of byte (slot >> 3).
+    for (int i = 0; i < 64; ++i) {
+        bytes[i] = (uint8_t)(entry->changed.words[i >> 3] >> ((i & 7) * 8));
+    }
+    return result;
+}
+
+void SacnReceiver::set_delivery_mode(int p_mode) {
+    delivery_mode = (p_mode >= DELIVERY_PER_UNIVERSE && p_mode <= DELIVERY_BOTH) ? p_mode : DELIVERY_PER_UNIVERSE;
+}
+
+int SacnReceiver::get_delivery_mode() const {
+    return delivery_mode;
+}
+
+bool SacnReceiver::replay_capture(const String &p_path, double p_speed) {
+    if (!SacnServer::get_singleton()->is_attached(this)) {
+        UtilityFunctions::print("SacNReceiver: Receiver not initialized. Cannot replay ", p_path);
+        return false;
+    }
+    gacn::PcapReplay::Config config;
+    config.path = ProjectSettings::get_singleton()->globalize_path(p_path).utf8().get_data();
+    config.speed = p_speed;
+    // Open errors are reported by the reader.
+    return replay.start(engine, config);
+}
+
+void SacnReceiver::stop_replay() {
+    replay.stop();
+}
+
+bool SacnReceiver::is_replaying() const {
+    return replay.is_running();
+}
+
+Dictionary SacnReceiver::get_replay_report() const {
+    gacn::PcapReplay::Report report = replay.get_report();
+    Dictionary result;
+    result["elapsed"] = report.elapsed;
+    result["capture_time"] = report.capture_time;
+    result["frames"] = (int64_t)report.frames;
+    result["skipped"] = (int64_t)report.skipped;
+    result["other_port"] = (int64_t)report.other_port;
+    result["fed"] = (int64_t)report.fed;
+    result["packet_rate"] = report.packet_rate;
+    result["finished"] = report.finished;
+    return result;
+}
+
 void SacnReceiver::set_preview(bool p_enable) {
     if (preview == p_enable) {
         return; // No change, no need to restart
@@ -82,22 +244,11 @@ void SacnReceiver::_ready() {
 
     if ((is_editor && preview) || (!is_editor && !preview)) {
         UtilityFunctions::print("SacNReceiver: Initializing E1.31 receiver...");
-        if ((sockfd = e131_socket()) < 0) {
-            UtilityFunctions::printerr("SacNReceiver: e131_socket failed: ", strerror(errno));
+        // The first receiver opens the socket pool and starts the receive threads
+        if (!SacnServer::get_singleton()->attach_receiver(this)) {
             return;
         }
-
-        if (e131_bind(sockfd, E131_DEFAULT_PORT) < 0) {
-            UtilityFunctions::printerr("SacNReceiver: e131_bind failed: ", strerror(errno));
-            close(sockfd);
-            sockfd = -1;
-            return;
-        }
-
-        // Start the receiver thread
-        running = true;
-        receiver_thread = std::thread(&SacnReceiver::_receiver_thread_func, this);
-        UtilityFunctions::print("SacNReceiver: Receiver thread started.");
+        UtilityFunctions::print("SacNReceiver: Attached to the shared receiver.");
     } else {
         UtilityFunctions::print("SacNReceiver: Not initializing receiver based on preview/editor settings.");
     }
@@ -111,28 +262,100 @@ void SacnReceiver::_exit_tree() {
 }
 
 void SacnReceiver::_exit() {
-    if (running.load()) {
-        running = false;
-        if (receiver_thread.joinable()) {
-            receiver_thread.join();
+    replay.stop();
+    SacnServer *server = SacnServer::get_singleton();
+    if (server != nullptr && server->is_attached(this)) {
+        // Groups other receivers still subscribe to stay joined.
+        server->detach_receiver(this);
+        UtilityFunctions::print("SacNReceiver: Detached from the shared receiver.");
+    }
+}
+
+void SacnReceiver::_process(double delta) {
+    std::vector<LostSource> sources;
+    std::vector<uint16_t> universes;
+    const bool packed = delivery_mode != DELIVERY_PER_UNIVERSE;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        // Copy the dirty universes into the reused frame buffers, in ascending
+        // order, so the receive thread is only held up for the copies.
+        frame_order.swap(dirty_universes);
+        dirty_universes.clear();
+        std::sort(frame_order.begin(), frame_order.end());
+
+        const int count = (int)frame_order.size();
+        frame_lengths.resize(count);
+        if (count > 0 && !packed) {
+            // Nobody wants the packed frame; each universe goes straight into
+            // the array its data_received will carry.
+            universe_data.resize(count);
+            for (int i = 0; i < count; ++i) {
+                Staged &entry = staged[frame_order[i]];
+                entry.dirty = false;
+                frame_lengths[i] = entry.length;
+                universe_data[i].resize(entry.length);
+                memcpy(universe_data[i].ptrw(), entry.data, entry.length);
+            }
+        } else if (count > 0) {
+            frame_universes.resize(count);
+            frame_data.resize(count * FRAME_STRIDE);
+            int32_t *universe_ptr = frame_universes.ptrw();
+            uint8_t *data_ptr = frame_data.ptrw();
+            for (int i = 0; i < count; ++i) {
+                Staged &entry = staged[frame_order[i]];
+                entry.dirty = false;
+                universe_ptr[i] = frame_order[i];
+                frame_lengths[i] = entry.length;
+                memcpy(data_ptr + i * FRAME_STRIDE, entry.data, entry.length);
+                memset(data_ptr + i * FRAME_STRIDE + entry.length, 0, FRAME_STRIDE - entry.length);
+            }
         }
-        UtilityFunctions::print("SacNReceiver: Receiver thread stopped.");
+
+        sources.swap(lost_sources);
+        universes.swap(lost_universes);
     }
 
-    if (sockfd >= 0) {
-        // No need to explicitly leave multicast groups, closing the socket handles it.
-        close(sockfd);
-        sockfd = -1;
-        UtilityFunctions::print("SacNReceiver: Socket closed.");
+    if (!frame_order.empty()) {
+        // Diff against what listeners saw last time, before anyone is told.
+        frame_number++;
+        const uint8_t *frame_ptr = packed ? frame_data.ptr() : nullptr;
+        for (size_t i = 0; i < frame_order.size(); ++i) {
+            Delivered &entry = delivered[frame_order[i]];
+            const uint8_t *data = packed ? frame_ptr + i * FRAME_STRIDE : universe_data[i].ptr();
+            gacn::diff_slots(entry.data, entry.length, data, frame_lengths[i], entry.changed);
+            memcpy(entry.data, data, frame_lengths[i]);
+            entry.length = frame_lengths[i];
+            entry.frame = frame_number;
+        }
+
+        if (!packed) {
+            for (size_t i = 0; i < frame_order.size(); ++i) {
+                emit_signal("data_received", frame_order[i], universe_data[i]);
+            }
+        } else if (delivery_mode == DELIVERY_BOTH) {
+            const uint8_t *data_ptr = frame_data.ptr();
+            for (size_t i = 0; i < frame_order.size(); ++i) {
+                PackedByteArray dmx_data;
+                dmx_data.resize(frame_lengths[i]);
+                memcpy(dmx_data.ptrw(), data_ptr + i * FRAME_STRIDE, frame_lengths[i]);
+                emit_signal("data_received", frame_order[i], dmx_data);
+            }
+        }
+        if (packed) {
+            emit_signal("frame_received", frame_universes, frame_data);
+        }
     }
-}
 
-void SacnReceiver::_process(double delta) {
-    std::unique_lock<std::mutex> lock(mtx);
-    for (auto const& [universe_id, data] : received_data) {
-        emit_signal("data_received", universe_id, data);
+    for (const LostSource &lost : sources) {
+        char cid[37];
+        snprintf(cid, sizeof(cid), "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+                lost.cid[0], lost.cid[1], lost.cid[2], lost.cid[3], lost.cid[4], lost.cid[5], lost.cid[6], lost.cid[7],
+                lost.cid[8], lost.cid[9], lost.cid[10], lost.cid[11], lost.cid[12], lost.cid[13], lost.cid[14], lost.cid[15]);
+        emit_signal("source_lost", String(cid), lost.universe_id, lost.terminated);
+    }
+    for (uint16_t universe_id : universes) {
+        emit_signal("universe_lost", universe_id);
     }
-    received_data.clear();
 }
 
 void SacnReceiver::_notification(int p_what) {
@@ -144,91 +367,29 @@ void SacnReceiver::_notification(int p_what) {
     }
 }
 
-void SacnReceiver::_receiver_thread_func() {
-    e131_packet_t packet;
-    e131_error_t error;
-    e131_addr_t sender_addr;
-    socklen_t sender_addr_len = sizeof(sender_addr);
-    char sender_ip[INET_ADDRSTRLEN];
-
-    while (running.load()) {
-        // Use a timeout to allow the thread to check the 'running' flag periodically
-        // and avoid blocking indefinitely on e131_recv.
-        // A small timeout (e.g., 100ms) is usually sufficient.
-        struct timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = 100000; // 100 ms
-
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        FD_SET(sockfd, &read_fds);
-
-        int select_ret = select(sockfd + 1, &read_fds, NULL, NULL, &tv);
-
-        if (select_ret < 0) {
-            if (errno == EINTR) {
-                // Interrupted system call, continue loop
-                continue;
-            }
-            UtilityFunctions::printerr("SacNReceiver: select failed: ", strerror(errno));
-            running = false; // Stop the thread on error
-            break;
-        }
-
-        if (select_ret == 0) {
-            // Timeout, no data received, check running flag again
-            continue;
-        }
-
-        ssize_t bytes_received = recvfrom(sockfd, (void *)packet.raw, sizeof(packet.raw), 0, (struct sockaddr *)&sender_addr, &sender_addr_len);
-        if (bytes_received < 0) {
-            if (errno == EINTR) {
-                // Interrupted system call, continue loop
-                continue;
-            }
-            UtilityFunctions::printerr("SacNReceiver: recvfrom failed: ", strerror(errno));
-            running = false; // Stop the thread on error
-            break;
-        }
-
-        // Print sender IP and port for debugging
-        inet_ntop(AF_INET, &(sender_addr.sin_addr), sender_ip, INET_ADDRSTRLEN);
-        // UtilityFunctions::print("SacNReceiver: Received packet from ", String(sender_ip), ":", ntohs(sender_addr.sin_port));
-        // UtilityFunctions::print("SacNReceiver: Universe from packet (host byte order): ", ntohs(packet.frame.universe)); // Print universe in host byte order for debugging
-
-        if ((error = e131_pkt_validate(&packet)) != E131_ERR_NONE) {
-            // UtilityFunctions::printerr("SacNReceiver: e131_pkt_validate: ", e131_strerror(error), ". Raw universe was: ", ntohs(packet.frame.universe));
-            continue;
-        }
-
-        uint16_t universe_id = ntohs(packet.frame.universe); // This conversion is already correct here
-
-        // Check if this universe is one we are actively listening for
-        if (active_universes.find(universe_id) == active_universes.end()) {
-            // Not an active universe, discard packet
-            UtilityFunctions::print("SacNReceiver: Received packet for non-active universe ", universe_id, ". Discarding.");
-            continue;
-        }
-
-        // Discard out-of-order packets
-        // last_seq map needs to be protected by mutex if accessed from multiple threads
-        std::unique_lock<std::mutex> lock(mtx);
-        uint8_t current_last_seq = last_seq[universe_id];
-        if (e131_pkt_discard(&packet, current_last_seq)) {
-            UtilityFunctions::print("SacNReceiver: warning: packet out of order received for universe ", universe_id);
-            last_seq[universe_id] = packet.frame.seq_number;
-            continue;
-        }
-        last_seq[universe_id] = packet.frame.seq_number;
+void SacnReceiver::_on_universe(uint16_t universe_id, const uint8_t *data, uint16_t length) {
+    // Called on the receiver thread once a packet is validated, sequenced and
+    // merged. Only the latest data per universe and frame is kept.
+    std::unique_lock<std::mutex> lock(mtx);
+    Staged &entry = staged[universe_id];
+    entry.length = length;
+    memcpy(entry.data, data, length);
+    if (!entry.dirty) {
+        entry.dirty = true;
+        dirty_universes.push_back(universe_id);
+    }
+}
 
-        // Extract DMX data
-        PackedByteArray dmx_data;
-        dmx_data.resize(ntohs(packet.dmp.prop_val_cnt) - 1); // -1 because the first byte is the start code (0x00)
-        for (size_t i = 0; i < dmx_data.size(); ++i) {
-            dmx_data.set(i, packet.dmp.prop_val[i + 1]); // Skip start code
-        }
+void SacnReceiver::_on_source_lost(const uint8_t *cid, uint16_t universe_id, bool terminated) {
+    LostSource lost;
+    memcpy(lost.cid, cid, sizeof(lost.cid));
+    lost.universe_id = universe_id;
+    lost.terminated = terminated;
+    std::unique_lock<std::mutex> lock(mtx);
+    lost_sources.push_back(lost);
+}
 
-        // Store received data
-        received_data[universe_id] = dmx_data;
-    }
+void SacnReceiver::_on_universe_lost(uint16_t universe_id) {
+    std::unique_lock<std::mutex> lock(mtx);
+    lost_universes.push_back(universe_id);
 }
@@ -4,38 +4,123 @@
 #include <godot_cpp/classes/node.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+#include "pcap_replay.hpp"
+#include "receiver_engine.hpp"
+#include "slot_diff.hpp"
 
-#include <thread>
-#include <atomic>
-#include <map>
 #include <mutex>
-#include <condition_variable>
-#include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace godot {
 
+class SacnServer;
+
+// A handle on the shared receiver engine in SacnServer. Universes activated
+// here are delivered to this node only; the socket pool, merging, loss
+// handling, interfaces and tuning are set on SacnServer for every receiver.
 class SacnReceiver : public Node {
     GDCLASS(SacnReceiver, Node);
+    friend class SacnServer;
+
+public:
+    enum DeliveryMode {
+        DELIVERY_PER_UNIVERSE, // data_received per dirty universe
+        DELIVERY_FRAME, // one frame_received per frame
+        DELIVERY_BOTH,
+    };
+
+    // Stride of each universe in the frame_received payload.
+    static const int FRAME_STRIDE = 512;
 
 private:
     bool preview = false;
     bool inited = false;
-    int sockfd = -1;
-    std::map<uint16_t, uint8_t> last_seq;
-    std::atomic<bool> running = false;
-    std::thread receiver_thread;
-    std::set<uint16_t> active_universes;
+    gacn::ReceiverEngine &engine;
+    int delivery_mode = DELIVERY_PER_UNIVERSE;
+    bool local_transport = false;
+    gacn::PcapReplay replay;
+
+    // Latest data per universe, written by the receive thread. Entries are
+    // allocated once per universe and overwritten afterwards.
+    struct Staged {
+        bool dirty = false;
+        uint16_t length = 0;
+        uint8_t data[512];
+    };
     std::mutex mtx;
-    std::condition_variable cv;
-    std::map<uint16_t, PackedByteArray> received_data;
+    std::unordered_map<uint16_t, Staged> staged;
+    std::vector<uint16_t> dirty_universes;
+
+    // Main thread side, reused every frame.
+    std::vector<uint16_t> frame_order;
+    std::vector<uint16_t> frame_lengths;
+    PackedInt32Array frame_universes;
+    PackedByteArray frame_data;
+    std::vector<PackedByteArray> universe_data; // DELIVERY_PER_UNIVERSE only
+
+    // What was last delivered per universe, for change tracking.
+    struct Delivered {
+        uint64_t frame = 0;
+        uint16_t length = 0;
+        uint8_t data[512];
+        gacn::SlotMask changed;
+    };
+    std::unordered_map<uint16_t, Delivered> delivered;
+    uint64_t frame_number = 0;
+    std::vector<int32_t> range_scratch;
 
-    void _receiver_thread_func();
+    const Delivered *_get_current_delivery(int universe_id) const;
+
+    struct LostSource {
+        uint8_t cid[16];
+        uint16_t universe_id;
+        bool terminated;
+    };
+    std::vector<LostSource> lost_sources;
+    std::vector<uint16_t> lost_universes;
+
+    // Called by SacnServer on a receive thread, for subscribed universes.
+    void _on_universe(uint16_t universe_id, const uint8_t *data, uint16_t length);
+    void _on_source_lost(const uint8_t *cid, uint16_t universe_id, bool terminated);
+    void _on_universe_lost(uint16_t universe_id);
 
 public:
     SacnReceiver();
     ~SacnReceiver();
 
-    void activate_universe(uint16_t universe_id);
+    // `interface` is a position in SacnServer.receiver_interfaces.
+    void activate_universe(uint16_t universe_id, int interface = 0);
+    int activate_universe_range(int first_universe, int count, int interface = 0);
+    bool is_universe_active(int universe_id) const;
+    int get_universe_interface(int universe_id) const;
+
+    // Also receive from SacnSenders on this machine through shared memory.
+    // Stays on while any receiver enables it.
+    void set_local_transport(bool p_enable);
+    bool get_local_transport() const;
+
+    // Slots (0-based) that changed in the frame just delivered, compared with
+    // the previous delivery of the same universe. Valid while handling
+    // data_received/frame_received; empty for universes not in this frame.
+    PackedInt32Array get_changed_ranges(int universe_id);
+    PackedByteArray get_dirty_mask(int universe_id) const;
+
+    void set_delivery_mode(int p_mode);
+    int get_delivery_mode() const;
+
+    // Feeds the sACN traffic of a pcap or pcapng capture into the shared
+    // receiver as if it arrived from the network, so every receiver
+    // subscribed to its universes gets it. speed 1 keeps the recorded
+    // timing, 0 feeds as fast as possible. The node must be receiving.
+    bool replay_capture(const String &p_path, double p_speed = 1.0);
+    void stop_replay();
+    bool is_replaying() const;
+    Dictionary get_replay_report() const;
+
     void set_preview(bool p_enable);
     bool is_preview() const; // Add a getter for the preview property
 
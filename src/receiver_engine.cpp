@@ -0,0 +1,539 @@
+#include "receiver_engine.hpp"
+
+#include "sacn_log.hpp"
+#include "thread_tuning.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <ctime>
+#include <poll.h>
+#include <sys/socket.h>
+#include <vector>
+
+namespace gacn {
+
+// Root + framing layers + DMP header, i.e. the offset of prop_val.
+static const size_t E131_HEADER_SIZE = sizeof(e131_packet_t) - 513;
+
+uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+ReceiverEngine::ReceiverEngine(uint16_t port) :
+        port(port), memberships(port) {
+}
+
+ReceiverEngine::~ReceiverEngine() {
+    stop();
+}
+
+void ReceiverEngine::set_universe_callback(UniverseCallback callback) {
+    universe_callback = std::move(callback);
+}
+
+void ReceiverEngine::set_packet_tap(PacketTap tap) {
+    packet_tap = std::move(tap);
+}
+
+void ReceiverEngine::set_source_lost_callback(SourceLostCallback callback) {
+    source_lost_callback = std::move(callback);
+}
+
+void ReceiverEngine::set_universe_lost_callback(UniverseLostCallback callback) {
+    universe_lost_callback = std::move(callback);
+}
+
+void ReceiverEngine::set_thread_cpu(int cpu) {
+    tuning.cpu = cpu;
+}
+
+void ReceiverEngine::set_latency_tuning(const LatencyTuning &p_tuning) {
+    tuning = p_tuning;
+}
+
+LatencyTuning ReceiverEngine::get_latency_tuning() const {
+    return tuning;
+}
+
+uint32_t ReceiverEngine::get_denied_tuning() const {
+    return denied_tuning.load() | memberships.get_denied_tuning();
+}
+
+void ReceiverEngine::set_local_transport(bool enabled) {
+    local_enabled = enabled;
+}
+
+bool ReceiverEngine::get_local_transport() const {
+    return local_enabled;
+}
+
+void ReceiverEngine::set_interfaces(const std::vector<NetInterface> &p_interfaces) {
+    memberships.set_interfaces(p_interfaces);
+}
+
+bool ReceiverEngine::start() {
+    if (running.load()) {
+        return true;
+    }
+    denied_tuning = 0;
+    memberships.set_socket_tuning(tuning);
+    if (!memberships.open()) {
+        return false;
+    }
+    {
+        // A replay may be feeding the stopped engine right now.
+        std::lock_guard<std::mutex> lock(merge_mtx);
+        merger.clear();
+        fades.clear();
+        last_fade_ns = 0;
+    }
+    if (local_enabled && !local_transport.open(port)) {
+        log_error("ReceiverEngine: local transport unavailable, receiving from the network only");
+    }
+    running = true;
+    for (int i = 0; i < memberships.get_interface_count(); ++i) {
+        receiver_threads.emplace_back(&ReceiverEngine::_receiver_thread_func, this, i);
+    }
+    if (local_transport.is_open()) {
+        local_thread = std::thread(&ReceiverEngine::_local_thread_func, this);
+    }
+    return true;
+}
+
+void ReceiverEngine::stop() {
+    if (running.exchange(false)) {
+        for (std::thread &thread : receiver_threads) {
+            thread.join();
+        }
+        receiver_threads.clear();
+        if (local_thread.joinable()) {
+            local_thread.join();
+        }
+    }
+    {
+        // Offline feeds run on the caller's clock; nothing timed on the
+        // receive threads' clock may be left for them.
+        std::lock_guard<std::mutex> lock(merge_mtx);
+        merger.clear();
+        fades.clear();
+        last_fade_ns = 0;
+    }
+    local_transport.close();
+    memberships.close_all();
+}
+
+bool ReceiverEngine::is_running() const {
+    return running.load();
+}
+
+MembershipManager &ReceiverEngine::get_memberships() {
+    return memberships;
+}
+
+const MembershipManager &ReceiverEngine::get_memberships() const {
+    return memberships;
+}
+
+void ReceiverEngine::set_merge_mode(MergeMode mode) {
+    merge_mode.store(mode);
+}
+
+MergeMode ReceiverEngine::get_merge_mode() const {
+    return (MergeMode)merge_mode.load();
+}
+
+void ReceiverEngine::set_loss_policy(LossPolicy policy) {
+    loss_policy.store(policy);
+}
+
+LossPolicy ReceiverEngine::get_loss_policy() const {
+    return (LossPolicy)loss_policy.load();
+}
+
+void ReceiverEngine::set_fade_time(uint64_t p_fade_ns) {
+    fade_ns.store(p_fade_ns);
+}
+
+uint64_t ReceiverEngine::get_fade_time() const {
+    return fade_ns.load();
+}
+
+void ReceiverEngine::set_source_timeout(uint64_t timeout_ns) {
+    source_timeout_ns.store(timeout_ns);
+}
+
+uint64_t ReceiverEngine::get_source_timeout() const {
+    return source_timeout_ns.load();
+}
+
+ReceiverEngine::Stats ReceiverEngine::get_stats() const {
+    Stats stats;
+    stats.packets = stat_packets.load(std::memory_order_relaxed);
+    stats.invalid = stat_invalid.load(std::memory_order_relaxed);
+    stats.not_joined = stat_not_joined.load(std::memory_order_relaxed);
+    stats.out_of_order = stat_out_of_order.load(std::memory_order_relaxed);
+    stats.sources_lost = stat_sources_lost.load(std::memory_order_relaxed);
+    stats.sources_terminated = stat_sources_terminated.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ReceiverEngine::_handle_datagram(const e131_packet_t &packet, size_t length, const e131_addr_t &from, const e131_addr_t &to, uint64_t now_ns, bool filter_joined) {
+    stat_packets.fetch_add(1, std::memory_order_relaxed);
+
+    if (length < E131_HEADER_SIZE || ntohs(packet.dmp.prop_val_cnt) > 513 ||
+            length < E131_HEADER_SIZE + ntohs(packet.dmp.prop_val_cnt) ||
+            e131_pkt_validate(&packet) != E131_ERR_NONE) {
+        stat_invalid.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Check if this universe is one we are actively listening for
+    uint16_t universe_id = ntohs(packet.frame.universe);
+    if (universe_id < 1 || universe_id > 63999 || (filter_joined && !memberships.is_joined(universe_id))) {
+        stat_not_joined.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    UniverseMerger::Output output;
+    UniverseMerger::Result result = merger.accept(packet, now_ns, output, [&](const UniverseMerger::Loss &loss) {
+        _on_loss(loss, now_ns);
+    });
+    if (result == UniverseMerger::RESULT_DISCARDED) {
+        stat_out_of_order.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (packet_tap) {
+        packet_tap(packet, length, from, to, result == UniverseMerger::RESULT_DISCARDED || result == UniverseMerger::RESULT_DUPLICATE);
+    }
+    if (result == UniverseMerger::RESULT_MERGED) {
+        if (!fades.empty()) {
+            // A source came back while the universe was fading out.
+            _cancel_fade(universe_id);
+        }
+        if (universe_callback) {
+            universe_callback(universe_id, output.data, output.length);
+        }
+    }
+}
+
+void ReceiverEngine::feed(const uint8_t *data, size_t length, const e131_addr_t &from, const e131_addr_t &to, uint64_t capture_ns) {
+    // Sampled once, so the clock, the join filter and the expiry below agree
+    // even if the engine starts or stops meanwhile; start() and stop() clear
+    // whatever the other clock left in the merger.
+    const bool offline = !running.load();
+    const uint64_t now_ns = offline ? capture_ns : monotonic_ns();
+    {
+        std::lock_guard<std::mutex> lock(merge_mtx);
+        if (offline) {
+            // No timekeeper thread to hand the settings over.
+            merger.set_mode((MergeMode)merge_mode.load(std::memory_order_relaxed));
+            merger.set_source_timeout(source_timeout_ns.load(std::memory_order_relaxed));
+        }
+        // Copied for alignment, and cut to a packet like the socket reads.
+        length = std::min(length, sizeof(feed_packet.raw));
+        std::memcpy(feed_packet.raw, data, length);
+        // Offline input has no memberships to go by.
+        _handle_datagram(feed_packet, length, from, to, now_ns, !offline);
+    }
+    // Nobody keeps time for a stopped engine; do it at the fade rate.
+    if (offline && now_ns - last_feed_expire_ns >= FADE_INTERVAL_MS * 1000000ull) {
+        last_feed_expire_ns = now_ns;
+        _expire_and_fade(now_ns);
+    }
+}
+
+void ReceiverEngine::_on_loss(const UniverseMerger::Loss &loss, uint64_t now_ns) {
+    if (loss.terminated) {
+        stat_sources_terminated.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        stat_sources_lost.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (source_lost_callback) {
+        source_lost_callback(loss.cid, loss.universe, loss.terminated);
+    }
+
+    if (loss.changed) {
+        if (universe_callback) {
+            universe_callback(loss.universe, loss.output.data, loss.output.length);
+        }
+        return;
+    }
+    if (!loss.universe_lost) {
+        return;
+    }
+
+    if (universe_lost_callback) {
+        universe_lost_callback(loss.universe);
+    }
+    LossPolicy policy = (LossPolicy)loss_policy.load(std::memory_order_relaxed);
+    if (policy == LOSS_FADE && fade_ns.load(std::memory_order_relaxed) == 0) {
+        policy = LOSS_BLACKOUT;
+    }
+    if (policy == LOSS_BLACKOUT) {
+        static const uint8_t zeros[512] = {};
+        if (universe_callback && loss.output.length > 0) {
+            universe_callback(loss.universe, zeros, loss.output.length);
+        }
+    } else if (policy == LOSS_FADE && loss.output.length > 0) {
+        _cancel_fade(loss.universe);
+        fades.emplace_back();
+        Fade &fade = fades.back();
+        fade.universe = loss.universe;
+        fade.length = loss.output.length;
+        fade.start = now_ns;
+        std::memcpy(fade.from, loss.output.data, loss.output.length);
+    }
+}
+
+void ReceiverEngine::_cancel_fade(uint16_t universe) {
+    for (size_t i = 0; i < fades.size(); ++i) {
+        if (fades[i].universe == universe) {
+            fades[i] = fades.back();
+            fades.pop_back();
+            return;
+        }
+    }
+}
+
+void ReceiverEngine::_advance_fades(uint64_t now_ns) {
+    if (fades.empty() || now_ns - last_fade_ns < FADE_INTERVAL_MS * 1000000ull) {
+        return;
+    }
+    last_fade_ns = now_ns;
+
+    const uint64_t duration = fade_ns.load(std::memory_order_relaxed);
+    uint8_t out[512];
+    for (size_t i = 0; i < fades.size();) {
+        const Fade &fade = fades[i];
+        // A fade started on a clock running ahead of this one has not begun.
+        const uint64_t elapsed = now_ns > fade.start ? now_ns - fade.start : 0;
+        // Remaining level in 16.16 fixed point.
+        const uint32_t level = elapsed >= duration ? 0 : (uint32_t)(((duration - elapsed) << 16) / duration);
+        for (uint16_t slot = 0; slot < fade.length; ++slot) {
+            out[slot] = (uint8_t)((fade.from[slot] * level) >> 16);
+        }
+        if (universe_callback) {
+            universe_callback(fade.universe, out, fade.length);
+        }
+        if (level == 0) {
+            fades[i] = fades.back();
+            fades.pop_back();
+            continue;
+        }
+        ++i;
+    }
+}
+
+// Room for the IP_PKTINFO control message of one datagram.
+static const size_t CONTROL_SIZE = CMSG_SPACE(sizeof(struct in_pktinfo));
+
+// Destination address from the IP header, network order; 0 if unknown.
+static uint32_t pktinfo_destination(struct msghdr &header) {
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO) {
+            struct in_pktinfo info;
+            std::memcpy(&info, CMSG_DATA(cmsg), sizeof(info));
+            return info.ipi_addr.s_addr;
+        }
+    }
+    return 0;
+}
+
+void ReceiverEngine::_receiver_thread_func(int interface) {
+    const int cpu = tuning.cpu >= 0 ? tuning.cpu + interface : -1;
+    char name[40];
+    std::snprintf(name, sizeof(name), "ReceiverEngine interface %d", interface);
+    denied_tuning.fetch_or(apply_thread_tuning(tuning, cpu, name));
+    // Source expiry and fades are driven by the first receive thread only.
+    const bool timekeeper = interface == 0;
+    const uint64_t spin_ns = (uint64_t)tuning.spin_us * 1000;
+
+    // Batch buffers for recvmmsg, allocated once per thread.
+    std::vector<e131_packet_t> packets(RECV_BATCH);
+    std::vector<e131_addr_t> addrs(RECV_BATCH);
+    std::vector<struct iovec> iovecs(RECV_BATCH);
+    std::vector<struct mmsghdr> msgs(RECV_BATCH);
+    std::vector<uint8_t> controls(RECV_BATCH * CONTROL_SIZE);
+    for (int i = 0; i < RECV_BATCH; ++i) {
+        iovecs[i].iov_base = packets[i].raw;
+        iovecs[i].iov_len = sizeof(packets[i].raw);
+    }
+    e131_addr_t to;
+    std::memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_port = htons(port);
+
+    // pollfds[0] is the membership manager's wake fd, the rest are the pool
+    // sockets. The set is rebuilt whenever the manager adds a socket.
+    std::vector<int> socket_fds;
+    std::vector<struct pollfd> pollfds;
+    uint32_t generation = memberships.get_generation() - 1;
+
+    while (running.load()) {
+        // Other threads add fades under merge_mtx; check for them while we
+        // hold it.
+        bool fading = false;
+        if (timekeeper) {
+            std::lock_guard<std::mutex> lock(merge_mtx);
+            merger.set_mode((MergeMode)merge_mode.load(std::memory_order_relaxed));
+            merger.set_source_timeout(source_timeout_ns.load(std::memory_order_relaxed));
+            fading = !fades.empty();
+        }
+
+        if (generation != memberships.get_generation()) {
+            generation = memberships.get_generation();
+            memberships.get_sockets(interface, socket_fds);
+            pollfds.clear();
+            pollfds.push_back({ memberships.get_wake_fd(interface), POLLIN, 0 });
+            for (int fd : socket_fds) {
+                pollfds.push_back({ fd, POLLIN, 0 });
+            }
+        }
+
+        // With spinning enabled, poll without sleeping for a while first so a
+        // packet arriving now is read without a scheduler wake-up.
+        int poll_ret = 0;
+        if (spin_ns > 0) {
+            const uint64_t spin_until = monotonic_ns() + spin_ns;
+            do {
+                poll_ret = poll(pollfds.data(), pollfds.size(), 0);
+            } while (poll_ret == 0 && monotonic_ns() < spin_until && running.load(std::memory_order_relaxed));
+        }
+        // Use a timeout to allow the thread to check the 'running' flag
+        // periodically, expire sources and step fades.
+        if (poll_ret == 0) {
+            poll_ret = poll(pollfds.data(), pollfds.size(), fading ? FADE_INTERVAL_MS : 100);
+        }
+        if (poll_ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log_error("ReceiverEngine: poll failed: %s", strerror(errno));
+            running = false;
+            break;
+        }
+        if (poll_ret == 0) {
+            if (timekeeper) {
+                _expire_and_fade(monotonic_ns());
+            }
+            continue;
+        }
+
+        if (pollfds[0].revents & POLLIN) {
+            memberships.clear_wake(interface);
+        }
+
+        for (size_t p = 1; p < pollfds.size(); ++p) {
+            if (!(pollfds[p].revents & POLLIN)) {
+                continue;
+            }
+
+            // Drain the socket in batches; pool sockets are non-blocking.
+            for (;;) {
+                for (int i = 0; i < RECV_BATCH; ++i) {
+                    std::memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+                    msgs[i].msg_hdr.msg_iov = &iovecs[i];
+                    msgs[i].msg_hdr.msg_iovlen = 1;
+                    msgs[i].msg_hdr.msg_name = &addrs[i];
+                    msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+                    msgs[i].msg_hdr.msg_control = &controls[i * CONTROL_SIZE];
+                    msgs[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+                }
+                int count = recvmmsg(pollfds[p].fd, msgs.data(), RECV_BATCH, 0, nullptr);
+                if (count < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        log_error("ReceiverEngine: recvmmsg failed: %s", strerror(errno));
+                    }
+                    break;
+                }
+
+                const uint64_t now = monotonic_ns();
+                std::lock_guard<std::mutex> lock(merge_mtx);
+                for (int i = 0; i < count; ++i) {
+                    to.sin_addr.s_addr = pktinfo_destination(msgs[i].msg_hdr);
+                    _handle_datagram(packets[i], msgs[i].msg_len, addrs[i], to, now, true);
+                }
+                if (count < RECV_BATCH) {
+                    break;
+                }
+            }
+        }
+        if (timekeeper) {
+            _expire_and_fade(monotonic_ns());
+        }
+    }
+}
+
+void ReceiverEngine::_expire_and_fade(uint64_t now_ns) {
+    std::lock_guard<std::mutex> lock(merge_mtx);
+    merger.expire(now_ns, [&](const UniverseMerger::Loss &loss) {
+        _on_loss(loss, now_ns);
+    });
+    _advance_fades(now_ns);
+}
+
+void ReceiverEngine::_local_thread_func() {
+    // Frames from local senders are turned back into packets so they take the
+    // same validation, sequencing and merge path as network traffic.
+    std::vector<uint16_t> universes;
+    std::vector<uint16_t> joined;
+    std::vector<uint8_t> listening(LocalTransport::MAX_UNIVERSE + 1, 0);
+    std::vector<uint32_t> seen(LocalTransport::MAX_UNIVERSE + 1, 0);
+    uint32_t join_version = memberships.get_join_version() - 1;
+    LocalTransport::Frame frame;
+    e131_packet_t packet;
+    e131_addr_t from;
+    std::memset(&from, 0, sizeof(from));
+    from.sin_family = AF_INET;
+    from.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    from.sin_port = htons(port);
+    const e131_addr_t &to = from;
+
+    while (running.load()) {
+        const uint32_t doorbell = local_transport.get_doorbell();
+        if (join_version != memberships.get_join_version()) {
+            join_version = memberships.get_join_version();
+            memberships.get_joined_universes(joined);
+            // The table outlives its writers, so a slot may still hold the
+            // last frame of a sender that is long gone. Only frames written
+            // after we start listening to a universe count.
+            for (uint16_t universe : joined) {
+                if (!listening[universe]) {
+                    seen[universe] = local_transport.get_version(universe);
+                }
+            }
+            for (uint16_t universe : universes) {
+                listening[universe] = 0;
+            }
+            for (uint16_t universe : joined) {
+                listening[universe] = 1;
+            }
+            universes.swap(joined);
+        }
+
+        for (uint16_t universe : universes) {
+            if (!local_transport.read(universe, seen[universe], frame)) {
+                continue;
+            }
+            e131_pkt_init(&packet, universe, frame.length);
+            std::memcpy(packet.root.cid, frame.cid, sizeof(packet.root.cid));
+            packet.frame.priority = frame.priority;
+            packet.frame.options = frame.options;
+            packet.frame.seq_number = frame.sequence;
+            std::memcpy(&packet.dmp.prop_val[1], frame.data, frame.length);
+
+            const size_t length = E131_HEADER_SIZE + 1 + frame.length;
+            std::lock_guard<std::mutex> lock(merge_mtx);
+            _handle_datagram(packet, length, from, to, monotonic_ns(), true);
+        }
+
+        local_transport.wait(doorbell, 100);
+    }
+}
+
+}
@@ -0,0 +1,174 @@
+#ifndef RECEIVER_ENGINE_HPP
+#define RECEIVER_ENGINE_HPP
+
+#include "e131.h"
+#include "local_transport.hpp"
+#include "membership_manager.hpp"
+#include "thread_tuning.hpp"
+#include "universe_merger.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gacn {
+
+// What a universe outputs once its last source is gone.
+enum LossPolicy {
+    LOSS_HOLD, // keep the last look
+    LOSS_BLACKOUT, // output zeros immediately
+    LOSS_FADE, // fade the last look to zero over the fade time
+};
+
+// Godot-independent sACN receive pipeline: socket pool, batched reads,
+// validation, per-source sequencing, merging and source loss handling.
+// Results are handed to callbacks on a receive thread, or on the local
+// transport thread for frames from senders on this machine; no two threads
+// run callbacks at the same time. There is one receive thread per network
+// interface, each draining only the sockets joined on its interface.
+class ReceiverEngine {
+public:
+    static const int RECV_BATCH = 32;
+    static const int FADE_INTERVAL_MS = 23; // ~44 Hz, the DMX refresh rate
+
+    // Merged data for one universe; data is only valid during the call. Also
+    // used for the output of blackout and fade loss policies.
+    typedef std::function<void(uint16_t universe, const uint8_t *data, uint16_t length)> UniverseCallback;
+    // Every valid packet before merging, with the sequencing verdict. `to` is
+    // the destination the datagram was addressed to: a multicast group or a
+    // local unicast address.
+    typedef std::function<void(const e131_packet_t &packet, size_t length, const e131_addr_t &from, const e131_addr_t &to, bool discarded)> PacketTap;
+    // A source stopped sending to a universe, by timeout or stream termination.
+    typedef std::function<void(const uint8_t *cid, uint16_t universe, bool terminated)> SourceLostCallback;
+    // The last source of a universe is gone; the loss policy applies from here.
+    typedef std::function<void(uint16_t universe)> UniverseLostCallback;
+
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t invalid = 0;
+        uint64_t not_joined = 0;
+        uint64_t out_of_order = 0;
+        uint64_t sources_lost = 0;
+        uint64_t sources_terminated = 0;
+    };
+
+    explicit ReceiverEngine(uint16_t port);
+    ~ReceiverEngine();
+
+    ReceiverEngine(const ReceiverEngine &) = delete;
+    ReceiverEngine &operator=(const ReceiverEngine &) = delete;
+
+    // Callbacks and thread settings must be set before start().
+    void set_universe_callback(UniverseCallback callback);
+    void set_packet_tap(PacketTap tap);
+    void set_source_lost_callback(SourceLostCallback callback);
+    void set_universe_lost_callback(UniverseLostCallback callback);
+    // Receive thread i is pinned to cpu + i.
+    void set_thread_cpu(int cpu);
+    // CPU pinning (as above), scheduling, socket options and spin-then-block
+    // polling for the receive threads. Applies from the next start().
+    void set_latency_tuning(const LatencyTuning &p_tuning);
+    LatencyTuning get_latency_tuning() const;
+    // TuningOption bits the OS refused since the last start().
+    uint32_t get_denied_tuning() const;
+    // Also reads joined universes from the shared-memory table of our port.
+    void set_local_transport(bool enabled);
+    bool get_local_transport() const;
+    // Interfaces to receive on; join universes on them through
+    // get_memberships(). Applies from the next start().
+    void set_interfaces(const std::vector<NetInterface> &p_interfaces);
+
+    bool start();
+    void stop();
+    bool is_running() const;
+
+    MembershipManager &get_memberships();
+    const MembershipManager &get_memberships() const;
+
+    // Runs one datagram through validation, sequencing, merging and the
+    // callbacks on the calling thread, for offline sources such as capture
+    // replay. While running, only joined universes are taken and the
+    // datagram arrives now, on the clock of the receive threads. While
+    // stopped, every universe is taken, the datagram arrives at capture_ns
+    // on any clock the caller keeps, and feed() also expires sources and
+    // steps fades. The engine may start or stop between two calls.
+    void feed(const uint8_t *data, size_t length, const e131_addr_t &from, const e131_addr_t &to, uint64_t capture_ns);
+
+    void set_merge_mode(MergeMode mode);
+    MergeMode get_merge_mode() const;
+
+    void set_loss_policy(LossPolicy policy);
+    LossPolicy get_loss_policy() const;
+    void set_fade_time(uint64_t fade_ns);
+    uint64_t get_fade_time() const;
+    void set_source_timeout(uint64_t timeout_ns);
+    uint64_t get_source_timeout() const;
+
+    Stats get_stats() const;
+
+private:
+    uint16_t port;
+    MembershipManager memberships;
+    std::vector<std::thread> receiver_threads;
+    std::atomic<bool> running{ false };
+    LatencyTuning tuning;
+    std::atomic<uint32_t> denied_tuning{ 0 };
+
+    bool local_enabled = false;
+    LocalTransport local_transport;
+    std::thread local_thread;
+
+    // Serialises the merger, fades and callbacks between the two threads.
+    std::mutex merge_mtx;
+
+    struct Fade {
+        uint16_t universe;
+        uint16_t length;
+        uint64_t start;
+        uint8_t from[512];
+    };
+
+    UniverseCallback universe_callback;
+    PacketTap packet_tap;
+    SourceLostCallback source_lost_callback;
+    UniverseLostCallback universe_lost_callback;
+
+    // The merger and fades are only touched under merge_mtx; settings are
+    // handed over atomically.
+    UniverseMerger merger;
+    std::atomic<int> merge_mode{ MERGE_LATEST };
+    std::atomic<int> loss_policy{ LOSS_HOLD };
+    std::atomic<uint64_t> fade_ns{ 1000000000ull };
+    std::atomic<uint64_t> source_timeout_ns{ UniverseMerger::SOURCE_TIMEOUT_NS };
+    std::vector<Fade> fades;
+    uint64_t last_fade_ns = 0;
+    uint64_t last_feed_expire_ns = 0;
+    e131_packet_t feed_packet;
+
+    std::atomic<uint64_t> stat_packets{ 0 };
+    std::atomic<uint64_t> stat_invalid{ 0 };
+    std::atomic<uint64_t> stat_not_joined{ 0 };
+    std::atomic<uint64_t> stat_out_of_order{ 0 };
+    std::atomic<uint64_t> stat_sources_lost{ 0 };
+    std::atomic<uint64_t> stat_sources_terminated{ 0 };
+
+    void _receiver_thread_func(int interface);
+    void _local_thread_func();
+    // Datagrams of universes nobody joined are dropped when filter_joined is
+    // set, as they always are for the sockets.
+    void _handle_datagram(const e131_packet_t &packet, size_t length, const e131_addr_t &from, const e131_addr_t &to, uint64_t now_ns, bool filter_joined);
+    void _on_loss(const UniverseMerger::Loss &loss, uint64_t now_ns);
+    void _cancel_fade(uint16_t universe);
+    void _advance_fades(uint64_t now_ns);
+    void _expire_and_fade(uint64_t now_ns);
+};
+
+// CLOCK_MONOTONIC in nanoseconds.
+uint64_t monotonic_ns();
+
+}
+
+#endif
@@ -1,29 +1,67 @@
 #include "register_types.h"
 #include <gdextension_interface.h>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
 
 // Include your E131Sender header
+#include "server.hpp"
 #include "sender.hpp"
 #include "receiver.hpp"
+#include "effect_layer.hpp"
+#include "effect_engine.hpp"
+#include "load_generator.hpp"
+#include "frame_cache.hpp"
+#include "cache_player.hpp"
+#include "sacn_log.hpp"
 
 using namespace godot;
 
+static SacnServer *sacn_server = nullptr;
+
+// Messages from the engine threads end up in the Godot output panel.
+static void godot_log_handler(gacn::LogLevel level, const char *message) {
+	if (level == gacn::LOG_ERROR) {
+		UtilityFunctions::printerr(message);
+	} else {
+		UtilityFunctions::print(message);
+	}
+}
+
 void initialize_gdextension_types(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
 
+	gacn::set_log_handler(godot_log_handler);
+
+	// Senders and receivers share the server's engines, so it exists first
+	ClassDB::register_class<SacnServer>();
+	sacn_server = memnew(SacnServer);
+	Engine::get_singleton()->register_singleton("SacnServer", sacn_server);
+
 	// Register your SacnSender class so Godot can instantiate it
 	ClassDB::register_class<SacnSender>();
 	ClassDB::register_class<SacnReceiver>();
+	ClassDB::register_class<SacnEffectLayer>();
+	ClassDB::register_class<SacnEffectEngine>();
+	ClassDB::register_class<SacnLoadGenerator>();
+	ClassDB::register_class<SacnFrameCache>();
+	ClassDB::register_class<SacnCachePlayer>();
 }
 
 void uninitialize_gdextension_types(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+
+	Engine::get_singleton()->unregister_singleton("SacnServer");
+	memdelete(sacn_server);
+	sacn_server = nullptr;
+
+	gacn::set_log_handler(nullptr);
 }
 
 extern "C" {
@@ -0,0 +1,39 @@
+#include "sacn_log.hpp"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+
+namespace gacn {
+
+static void default_log_handler(LogLevel level, const char *message) {
+    std::fprintf(level == LOG_ERROR ? stderr : stdout, "%s\n", message);
+}
+
+static std::atomic<LogHandler> log_handler(default_log_handler);
+
+void set_log_handler(LogHandler handler) {
+    log_handler.store(handler ? handler : default_log_handler);
+}
+
+static void log_va(LogLevel level, const char *format, va_list args) {
+    char message[512];
+    std::vsnprintf(message, sizeof(message), format, args);
+    log_handler.load()(level, message);
+}
+
+void log_info(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    log_va(LOG_INFO, format, args);
+    va_end(args);
+}
+
+void log_error(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    log_va(LOG_ERROR, format, args);
+    va_end(args);
+}
+
+}
@@ -0,0 +1,33 @@
+#ifndef SACN_LOG_HPP
+#define SACN_LOG_HPP
+
+// Logging shim for the Godot-independent parts of the extension (engines,
+// queues, sockets). The GDExtension routes messages to the Godot console,
+// standalone tools fall back to stderr.
+
+namespace gacn {
+
+enum LogLevel {
+    LOG_INFO,
+    LOG_ERROR,
+};
+
+typedef void (*LogHandler)(LogLevel level, const char *message);
+
+void set_log_handler(LogHandler handler);
+
+void log_info(const char *format, ...)
+#ifdef __GNUC__
+        __attribute__((format(printf, 1, 2)))
+#endif
+        ;
+
+void log_error(const char *format, ...)
+#ifdef __GNUC__
+        __attribute__((format(printf, 1, 2)))
+#endif
+        ;
+
+}
+
+#endif
@@ -1,9 +1,7 @@
 #include "sender.hpp"
+#include "server.hpp"
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
-#include <cstring>
-#include <unistd.h>
-#include <err.h>
 
 namespace godot {
 
@@ -29,26 +27,64 @@ void SacnSender::_bind_methods() {
     ClassDB::add_property("SacnSender", PropertyInfo(Variant::BOOL, "use_multicast"), "set_use_multicast", "get_use_multicast");
 
     ClassDB::bind_method(D_METHOD("send_data", "data"), &SacnSender::send_data);
+    ClassDB::bind_method(D_METHOD("send_universe_data", "universe_id", "data"), &SacnSender::send_universe_data);
+
+    ClassDB::bind_method(D_METHOD("set_local_transport", "enable"), &SacnSender::set_local_transport);
+    ClassDB::bind_method(D_METHOD("get_local_transport"), &SacnSender::get_local_transport);
+    ClassDB::add_property("SacnSender", PropertyInfo(Variant::BOOL, "local_transport"), "set_local_transport", "get_local_transport");
+
+    ClassDB::bind_method(D_METHOD("set_network_output", "enable"), &SacnSender::set_network_output);
+    ClassDB::bind_method(D_METHOD("get_network_output"), &SacnSender::get_network_output);
+    ClassDB::add_property("SacnSender", PropertyInfo(Variant::BOOL, "network_output"), "set_network_output", "get_network_output");
 }
 
-SacnSender::SacnSender() : sequence_number(0), use_multicast(true) {
-    // create a socket for E1.31
-    if ((sockfd = e131_socket()) < 0){
-        UtilityFunctions::print("e131_socket failed");
-    }
+SacnSender::SacnSender() : engine(SacnServer::get_singleton()->get_sender_engine()) {
+    set_destination_address(destination_address);
+}
 
-    // configure socket to use the default network interface for outgoing multicast data
-    if (e131_multicast_iface(sockfd, 0) < 0){
-        UtilityFunctions::print("e131_multicast_iface failed");
+SacnSender::~SacnSender() {
+    _detach();
+}
+
+void SacnSender::_enter_tree() {
+    // Not in the constructor: ClassDB builds instances to read defaults from,
+    // and those must not start the worker threads.
+    SacnServer *server = SacnServer::get_singleton();
+    if (local_transport) {
+        // Before attaching, so a first sender starts with the table open.
+        server->acquire_sender_local_transport(port);
     }
+    server->attach_sender();
+    attached = true;
 }
 
-SacnSender::~SacnSender() {
-    close(sockfd);
+void SacnSender::_exit_tree() {
+    _detach();
+}
+
+void SacnSender::_detach() {
+    SacnServer *server = SacnServer::get_singleton();
+    if (!attached || server == nullptr) {
+        return;
+    }
+    attached = false;
+    if (local_transport) {
+        server->release_sender_local_transport(port);
+    }
+    server->detach_sender();
 }
 
 void SacnSender::set_destination_address(const String& address) {
     destination_address = address;
+
+    // Resolve once here instead of on every packet; the sender thread only
+    // ever sees the numeric address.
+    e131_addr_t resolved;
+    if (e131_unicast_dest(&resolved, destination_address.utf8().get_data(), port) < 0) {
+        UtilityFunctions::printerr("SacnSender: e131_unicast_dest failed for ", destination_address);
+        return;
+    }
+    unicast_addr = resolved.sin_addr.s_addr;
 }
 
 String SacnSender::get_destination_address() const {
@@ -64,6 +100,10 @@ int SacnSender::get_universe() const {
 }
 
 void SacnSender::set_port(const int& port_number) {
+    if (attached && local_transport && port_number != port) {
+        SacnServer::get_singleton()->release_sender_local_transport(port);
+        SacnServer::get_singleton()->acquire_sender_local_transport(port_number);
+    }
     port = port_number;
 }
 
@@ -87,38 +127,62 @@ bool SacnSender::get_use_multicast() const {
     return use_multicast;
 }
 
+gacn::SendTarget SacnSender::_make_target() const {
+    gacn::SendTarget target;
+    target.multicast = use_multicast.load(std::memory_order_relaxed);
+    target.unicast_addr = unicast_addr.load(std::memory_order_relaxed);
+    target.port = port.load(std::memory_order_relaxed);
+    target.preview = preview.load(std::memory_order_relaxed);
+    target.network = network_output.load(std::memory_order_relaxed);
+    return target;
+}
+
 void SacnSender::send_data(const PackedByteArray& data) {
-    // Increment sequence number
-    sequence_number++;
-
-    // initialize the new E1.31 packet
-    e131_pkt_init(&packet, universe, data.size());
-    std::memcpy(&packet.frame.source_name, "Godot sACN Sender", 18);
-    e131_set_option(&packet, E131_OPT_PREVIEW, preview);
-    packet.frame.seq_number = sequence_number;
-
-    // set remote system destination
-    if (use_multicast) {
-        if (e131_multicast_dest(&dest, universe, port) < 0) {
-            UtilityFunctions::print("e131_multicast_dest failed");
-            return;
-        }
-    } else {
-        if (e131_unicast_dest(&dest, destination_address.utf8().get_data(), port) < 0){
-            UtilityFunctions::print("e131_unicast_dest failed");
-            return;
-        }
-    }
+    send_universe_data(universe.load(std::memory_order_relaxed), data);
+}
 
-    // copy data to packet
-    for (int i = 0; i < data.size(); ++i) {
-        packet.dmp.prop_val[i + 1] = data[i];
+bool SacnSender::send_universe_data(const int& universe_id, const PackedByteArray& data) {
+    if (universe_id < 1 || universe_id > gacn::SenderEngine::MAX_UNIVERSE) {
+        UtilityFunctions::printerr("SacnSender: invalid universe ", universe_id);
+        return false;
+    }
+    if (data.size() < 1 || data.size() > 512) {
+        UtilityFunctions::printerr("SacnSender: data must hold 1 to 512 slots, got ", data.size());
+        return false;
     }
+    return submit_universe(universe_id, data.ptr(), data.size());
+}
+
+bool SacnSender::submit_universe(uint16_t universe_id, const uint8_t *data, uint16_t length) {
+    return engine.submit(universe_id, data, length, _make_target());
+}
 
-    if (e131_send(sockfd, &packet, &dest) < 0){
-        UtilityFunctions::print("e131_send failed");
+void SacnSender::set_local_transport(bool p_enable) {
+    if (local_transport == p_enable) {
         return;
     }
+    local_transport = p_enable;
+    // Counted per sender in the tree, so one sender turning it off leaves it
+    // on for the others.
+    if (!attached) {
+        return;
+    } else if (p_enable) {
+        SacnServer::get_singleton()->acquire_sender_local_transport(port);
+    } else {
+        SacnServer::get_singleton()->release_sender_local_transport(port);
+    }
+}
+
+bool SacnSender::get_local_transport() const {
+    return local_transport;
+}
+
+void SacnSender::set_network_output(bool p_enable) {
+    network_output = p_enable;
+}
+
+bool SacnSender::get_network_output() const {
+    return network_output;
 }
 
 }
@@ -5,22 +5,34 @@
 #include <godot_cpp/core/property_info.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include "e131.h"
+#include "sender_engine.hpp"
+
+#include <atomic>
 
 namespace godot {
 
+// A handle on the shared sender engine in SacnServer. Destination, universe
+// and preview are per node; the source CID belongs to the engine, and output
+// processing, workers, interfaces, tuning and congestion handling are set on
+// SacnServer for every sender.
 class SacnSender : public Node {
     GDCLASS(SacnSender, Node);
 
 private:
-    int sockfd;
-    e131_packet_t packet;
-    e131_addr_t dest;
+    gacn::SenderEngine &engine;
     String destination_address = "127.0.0.1";
-    int universe = 1;
-    int port = E131_DEFAULT_PORT;
-    bool preview = true;
-    uint8_t sequence_number;
-    bool use_multicast;
+    // Read by send_data()/send_universe_data() from any thread.
+    std::atomic<int> universe{ 1 };
+    std::atomic<uint32_t> unicast_addr{ 0 };
+    std::atomic<int> port{ E131_DEFAULT_PORT };
+    std::atomic<bool> preview{ true };
+    std::atomic<bool> use_multicast{ true };
+    std::atomic<bool> network_output{ true };
+    bool local_transport = false;
+    bool attached = false;
+
+    gacn::SendTarget _make_target() const;
+    void _detach();
 
 protected:
     static void _bind_methods();
@@ -29,6 +41,11 @@ public:
     SacnSender();
     ~SacnSender();
 
+    // The shared engine runs while senders are in the tree; a sender outside
+    // it sends nothing.
+    void _enter_tree() override;
+    void _exit_tree() override;
+
     void set_destination_address(const String& address);
     String get_destination_address() const;
 
@@ -44,7 +61,25 @@ public:
     void set_use_multicast(const bool& use_multicast);
     bool get_use_multicast() const;
 
+    // Both are safe to call from any thread, e.g. WorkerThreadPool tasks.
     void send_data(const PackedByteArray& data);
+    bool send_universe_data(const int& universe_id, const PackedByteArray& data);
+    // C++ fast path for native producers, also thread-safe.
+    bool submit_universe(uint16_t universe_id, const uint8_t *data, uint16_t length);
+    // Lets native producers render straight into the queued frame.
+    template <typename F>
+    bool submit_universe_with(uint16_t universe_id, uint16_t length, F &&fill) {
+        return engine.submit_with(universe_id, length, _make_target(), fill);
+    }
+
+    // Shared-memory output for receivers on this machine (same port), with or
+    // without the regular UDP output. It stays on while any sender in the
+    // tree enables it, on one port: senders on other ports reach local
+    // receivers over the network. Turning it on or off restarts the engine.
+    void set_local_transport(bool p_enable);
+    bool get_local_transport() const;
+    void set_network_output(bool p_enable);
+    bool get_network_output() const;
 };
 
 }
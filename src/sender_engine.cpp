@@ -0,0 +1,725 @@
+#include "sender_engine.hpp"
+
+#include "sacn_log.hpp"
+#include "thread_tuning.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <poll.h>
+#include <random>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace gacn {
+
+SenderEngine::SenderEngine() {
+    // E1.31 identifies sources by CID, so every engine gets its own UUIDv4.
+    std::random_device random;
+    for (int i = 0; i < 16; i += 4) {
+        uint32_t value = random();
+        std::memcpy(&cid[i], &value, 4);
+    }
+    cid[6] = (cid[6] & 0x0f) | 0x40;
+    cid[8] = (cid[8] & 0x3f) | 0x80;
+
+    interfaces.emplace_back();
+    universe_interfaces.assign(MAX_UNIVERSE + 1, 0);
+    routes.assign(MAX_UNIVERSE + 1, 0);
+}
+
+SenderEngine::Worker::Worker() {
+    std::memset(packets, 0, sizeof(packets));
+    std::memset(dests, 0, sizeof(dests));
+    std::memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < SEND_BATCH; ++i) {
+        iovecs[i].iov_base = packets[i].raw;
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &dests[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(dests[i]);
+    }
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+SenderEngine::Worker::~Worker() {
+    if (wake_fd >= 0) {
+        close(wake_fd);
+    }
+}
+
+SenderEngine::~SenderEngine() {
+    stop();
+}
+
+bool SenderEngine::start(size_t queue_capacity) {
+    if (running.load()) {
+        return true;
+    }
+    denied_tuning = 0;
+
+    const int interface_count = (int)interfaces.size();
+    bool unknown_interface = false;
+
+    // Receivers would drop a universe whose sequence jumps backwards, so every
+    // universe carries its sequence number over to wherever it is sent next.
+    std::vector<uint8_t> sequences(MAX_UNIVERSE + 1, 0);
+    if (!workers.empty()) {
+        for (uint32_t universe = 1; universe <= MAX_UNIVERSE; ++universe) {
+            const int from = routes[universe] * workers_per_interface + universe % workers_per_interface;
+            sequences[universe] = workers[from]->sequence_numbers[universe];
+        }
+    }
+
+    // Workers survive a restart with the same count.
+    if ((int)workers.size() != interface_count * worker_count) {
+        workers.clear();
+        for (int i = 0; i < interface_count * worker_count; ++i) {
+            workers.emplace_back(new Worker());
+            workers.back()->index = i;
+        }
+    }
+    for (std::unique_ptr<Worker> &worker : workers) {
+        worker->interface = worker->index / worker_count;
+    }
+    for (uint32_t universe = 1; universe <= MAX_UNIVERSE; ++universe) {
+        const uint8_t route = universe_interfaces[universe] < interface_count ? universe_interfaces[universe] : 0;
+        unknown_interface |= universe_interfaces[universe] >= interface_count;
+        routes[universe] = route;
+        workers[route * worker_count + universe % worker_count]->sequence_numbers[universe] = sequences[universe];
+    }
+    workers_per_interface = worker_count;
+    if (unknown_interface) {
+        log_error("SenderEngine: some universes are assigned to interfaces beyond the %d configured, sending them on interface 0", interface_count);
+    }
+
+    for (std::unique_ptr<Worker> &worker : workers) {
+        if (!_open_socket(*worker)) {
+            for (std::unique_ptr<Worker> &opened : workers) {
+                if (opened->sockfd >= 0) {
+                    close(opened->sockfd);
+                    opened->sockfd = -1;
+                }
+            }
+            return false;
+        }
+        // The drained queue is kept unless the capacity changed; stop()
+        // already waited out every producer that could still hold it.
+        if (!worker->queue || worker->queue_capacity != queue_capacity) {
+            worker->queue.reset(new MpscQueue<OutboundFrame>(queue_capacity));
+            worker->queue_capacity = queue_capacity;
+        }
+    }
+
+    impaired = impairment.loss > 0.0 || impairment.reorder > 0.0;
+    for (std::unique_ptr<Worker> &worker : workers) {
+        // xorshift64 must not start at zero.
+        worker->random_state = (impairment.seed ^ (0x9e3779b97f4a7c15ull * (worker->index + 1))) | 1;
+        worker->held.clear();
+        worker->held.reserve(impaired ? MAX_HELD : 0);
+        const bool dropping = congestion_policy == CONGESTION_DROP_OLDEST;
+        worker->backlog.resize(congestion_policy == CONGESTION_BLOCK ? 0 : backlog_capacity);
+        worker->backlog_slots.assign(congestion_policy == CONGESTION_BLOCK ? 0 : MAX_UNIVERSE + 1, 0);
+        worker->backlog_oldest.assign(dropping ? MAX_UNIVERSE + 1 : 0, 0);
+        worker->backlog_counts.assign(dropping ? MAX_UNIVERSE + 1 : 0, 0);
+        worker->backlog_head = 0;
+        worker->backlog_count = 0;
+    }
+
+    if (local_port != 0 && !local_transport.open(local_port)) {
+        log_error("SenderEngine: local transport unavailable, sending over the network only");
+    }
+
+    running = true;
+    for (std::unique_ptr<Worker> &worker : workers) {
+        worker->thread = std::thread(&SenderEngine::_worker_thread_func, this, std::ref(*worker));
+    }
+    return true;
+}
+
+bool SenderEngine::_open_socket(Worker &worker) {
+    const NetInterface &iface = interfaces[worker.interface];
+
+    // create a socket for E1.31
+    if ((worker.sockfd = e131_socket()) < 0) {
+        log_error("SenderEngine: e131_socket failed: %s", strerror(errno));
+        return false;
+    }
+
+    // Bind to the interface's address so unicast leaves with it as the source,
+    // and send multicast out of the interface itself.
+    if (iface.address != 0) {
+        e131_addr_t local;
+        std::memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = iface.address;
+        if (bind(worker.sockfd, (const struct sockaddr *)&local, sizeof(local)) < 0) {
+            log_error("SenderEngine: bind to %s failed: %s", iface.name.c_str(), strerror(errno));
+        }
+    }
+    if (e131_multicast_iface(worker.sockfd, iface.index) < 0) {
+        log_error("SenderEngine: e131_multicast_iface failed for %s: %s",
+                iface.index != 0 ? iface.name.c_str() : "the default interface", strerror(errno));
+    }
+    denied_tuning.fetch_or(apply_socket_tuning(worker.sockfd, tuning, false, "SenderEngine"));
+
+    // A full socket buffer is left to the congestion policy.
+    fcntl(worker.sockfd, F_SETFL, fcntl(worker.sockfd, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+void SenderEngine::stop() {
+    if (running.exchange(false)) {
+        // Producers that saw `running` set finish their push first, so the
+        // workers drain every accepted frame and start() can rebuild safely.
+        while (producers.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        for (std::unique_ptr<Worker> &worker : workers) {
+            uint64_t one = 1;
+            if (write(worker->wake_fd, &one, sizeof(one)) < 0) {
+                // The worker still sees `running` on its next timeout.
+            }
+        }
+        for (std::unique_ptr<Worker> &worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+
+    for (std::unique_ptr<Worker> &worker : workers) {
+        if (worker->sockfd >= 0) {
+            close(worker->sockfd);
+            worker->sockfd = -1;
+        }
+    }
+    local_transport.close();
+}
+
+bool SenderEngine::is_running() const {
+    return running.load();
+}
+
+void SenderEngine::set_thread_cpu(int cpu) {
+    tuning.cpu = cpu;
+}
+
+void SenderEngine::set_latency_tuning(const LatencyTuning &p_tuning) {
+    tuning = p_tuning;
+}
+
+LatencyTuning SenderEngine::get_latency_tuning() const {
+    return tuning;
+}
+
+uint32_t SenderEngine::get_denied_tuning() const {
+    return denied_tuning.load();
+}
+
+void SenderEngine::set_worker_count(int count) {
+    worker_count = count < 1 ? 1 : (count > MAX_WORKERS ? MAX_WORKERS : count);
+}
+
+int SenderEngine::get_worker_count() const {
+    return worker_count;
+}
+
+void SenderEngine::set_interfaces(const std::vector<NetInterface> &p_interfaces) {
+    interfaces = p_interfaces;
+    if (interfaces.size() > (size_t)MAX_INTERFACES) {
+        log_error("SenderEngine: only the first %d interfaces are used", MAX_INTERFACES);
+        interfaces.resize(MAX_INTERFACES);
+    }
+    if (interfaces.empty()) {
+        interfaces.emplace_back();
+    }
+}
+
+const std::vector<NetInterface> &SenderEngine::get_interfaces() const {
+    return interfaces;
+}
+
+bool SenderEngine::set_universe_interface(uint16_t universe, int interface) {
+    if (universe < 1 || universe > MAX_UNIVERSE || interface < 0 || interface >= MAX_INTERFACES) {
+        return false;
+    }
+    universe_interfaces[universe] = (uint8_t)interface;
+    return true;
+}
+
+int SenderEngine::get_universe_interface(uint16_t universe) const {
+    return universe <= MAX_UNIVERSE ? universe_interfaces[universe] : 0;
+}
+
+void SenderEngine::set_local_transport_port(uint16_t port) {
+    local_port = port;
+}
+
+uint16_t SenderEngine::get_local_transport_port() const {
+    return local_port;
+}
+
+void SenderEngine::set_impairment(const Impairment &p_impairment) {
+    impairment = p_impairment;
+}
+
+void SenderEngine::set_congestion_policy(CongestionPolicy policy) {
+    congestion_policy = policy;
+}
+
+CongestionPolicy SenderEngine::get_congestion_policy() const {
+    return congestion_policy;
+}
+
+void SenderEngine::set_backlog_capacity(int backlog) {
+    backlog_capacity = backlog < 0 ? 0 : (backlog > 65536 ? 65536 : backlog);
+}
+
+int SenderEngine::get_backlog_capacity() const {
+    return backlog_capacity;
+}
+
+void SenderEngine::set_universe_backlog(int p_universe_backlog) {
+    universe_backlog = p_universe_backlog < 1 ? 1 : (p_universe_backlog > 256 ? 256 : p_universe_backlog);
+}
+
+int SenderEngine::get_universe_backlog() const {
+    return universe_backlog;
+}
+
+void SenderEngine::set_block_timeout(int p_block_timeout_us) {
+    block_timeout_us = p_block_timeout_us < 0 ? 0 : p_block_timeout_us;
+}
+
+int SenderEngine::get_block_timeout() const {
+    return block_timeout_us;
+}
+
+void SenderEngine::set_source_name(const char *name) {
+    std::memset(source_name, 0, sizeof(source_name));
+    std::strncpy(source_name, name, sizeof(source_name) - 1);
+}
+
+bool SenderEngine::submit(uint16_t universe, const uint8_t *data, uint16_t length, const SendTarget &target) {
+    return submit_with(universe, length, target, [&](uint8_t *out) {
+        std::memcpy(out, data, length);
+    });
+}
+
+void SenderEngine::_wake_worker(Worker &worker) {
+    // Pairs with the fence in _wait_for_work(): either the worker sees the new
+    // frame before sleeping, or we see it sleeping and wake it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.sleeping.load(std::memory_order_relaxed)) {
+        uint64_t one = 1;
+        if (write(worker.wake_fd, &one, sizeof(one)) < 0) {
+            // The worker still comes back on its next timeout.
+        }
+    }
+}
+
+uint64_t SenderEngine::get_sent_count() const {
+    return sent_count.load(std::memory_order_relaxed);
+}
+
+uint64_t SenderEngine::get_dropped_count() const {
+    return dropped_count.load(std::memory_order_relaxed);
+}
+
+uint64_t SenderEngine::get_local_count() const {
+    return local_count.load(std::memory_order_relaxed);
+}
+
+uint64_t SenderEngine::get_coalesced_count() const {
+    return coalesced_count.load(std::memory_order_relaxed);
+}
+
+uint64_t SenderEngine::get_congestion_dropped_count() const {
+    return congestion_dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t SenderEngine::get_send_error_count() const {
+    return send_errors.load(std::memory_order_relaxed);
+}
+
+uint64_t SenderEngine::get_impaired_lost_count() const {
+    return impaired_lost.load(std::memory_order_relaxed);
+}
+
+uint64_t SenderEngine::get_impaired_reordered_count() const {
+    return impaired_reordered.load(std::memory_order_relaxed);
+}
+
+OutputStage &SenderEngine::get_output_stage() {
+    return output_stage;
+}
+
+const OutputStage &SenderEngine::get_output_stage() const {
+    return output_stage;
+}
+
+void SenderEngine::_wait_for_work(Worker &worker) {
+    if (tuning.spin_us > 0 && worker.backlog_count == 0) {
+        // Spin first: a frame arriving now is picked up without a wake-up.
+        const auto spin_until = std::chrono::steady_clock::now() + std::chrono::microseconds(tuning.spin_us);
+        do {
+            if (!worker.queue->empty() || !running.load(std::memory_order_relaxed)) {
+                return;
+            }
+            cpu_relax();
+        } while (std::chrono::steady_clock::now() < spin_until);
+    }
+
+    worker.sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.queue->empty() && running.load()) {
+        // With a backlog, also come back as soon as the socket has room again.
+        // The timeout is only a safety net, wake-ups come from submit() and stop().
+        struct pollfd pfds[2] = { { worker.wake_fd, POLLIN, 0 }, { worker.sockfd, POLLOUT, 0 } };
+        poll(pfds, worker.backlog_count > 0 ? 2 : 1, 100);
+    }
+    worker.sleeping.store(false, std::memory_order_relaxed);
+    uint64_t value;
+    if (read(worker.wake_fd, &value, sizeof(value)) < 0) {
+        // Nothing pending.
+    }
+}
+
+void SenderEngine::_worker_thread_func(Worker &worker) {
+    const int cpu = tuning.cpu >= 0 ? tuning.cpu + worker.index : -1;
+    char name[32];
+    std::snprintf(name, sizeof(name), "SenderEngine worker %d", worker.index);
+    denied_tuning.fetch_or(apply_thread_tuning(tuning, cpu, name));
+
+    auto build = [this, &worker](OutboundFrame &frame) { _build_packet(worker, frame); };
+    for (;;) {
+        bool did_work = false;
+        // Gather up to a batch worth of frames, then hand them to the kernel at once.
+        while (worker.queue->try_pop(build)) {
+            did_work = true;
+            if (worker.pending == SEND_BATCH) {
+                _flush(worker);
+            }
+        }
+        _flush(worker);
+
+        if (!running.load()) {
+            // Flush anything that raced with stop() and exit.
+            while (worker.queue->try_pop(build)) {
+                if (worker.pending == SEND_BATCH) {
+                    _flush(worker);
+                }
+            }
+            _flush(worker);
+            _release_held(worker, true);
+            _drain_backlog(worker);
+            congestion_dropped.fetch_add(worker.backlog_count, std::memory_order_relaxed);
+            _pop_backlog(worker, worker.backlog_count);
+            break;
+        }
+        if (!did_work) {
+            _wait_for_work(worker);
+        }
+    }
+}
+
+void SenderEngine::_build_packet(Worker &worker, const OutboundFrame &frame) {
+    e131_packet_t &packet = worker.packets[worker.pending];
+    e131_addr_t &dest = worker.dests[worker.pending];
+
+    // initialize the new E1.31 packet
+    e131_pkt_init(&packet, frame.universe, frame.length);
+    std::memcpy(packet.root.cid, cid, sizeof(packet.root.cid));
+    std::memcpy(&packet.frame.source_name, source_name, sizeof(packet.frame.source_name));
+    e131_set_option(&packet, E131_OPT_PREVIEW, frame.target.preview);
+    packet.frame.priority = frame.target.priority;
+    packet.frame.seq_number = ++worker.sequence_numbers[frame.universe];
+
+    // copy data to packet through the output processing stage
+    output_stage.process(worker.output_state, frame.universe, frame.data, &packet.dmp.prop_val[1], frame.length);
+
+    if (local_transport.is_open()) {
+        local_transport.write(frame.universe, cid, packet.frame.priority, packet.frame.options, packet.frame.seq_number,
+                &packet.dmp.prop_val[1], frame.length);
+        local_count.fetch_add(1, std::memory_order_relaxed);
+        worker.local_pending = true;
+    }
+    if (!frame.target.network) {
+        // The slot is reused by the next frame.
+        return;
+    }
+
+    // set remote system destination
+    if (frame.target.multicast) {
+        if (e131_multicast_dest(&dest, frame.universe, frame.target.port) < 0) {
+            log_error("SenderEngine: e131_multicast_dest failed for universe %u", frame.universe);
+            return;
+        }
+    } else {
+        dest.sin_family = AF_INET;
+        dest.sin_addr.s_addr = frame.target.unicast_addr;
+        dest.sin_port = htons(frame.target.port);
+    }
+
+    const size_t length = sizeof(packet.raw) - sizeof(packet.dmp.prop_val) + frame.length + 1;
+    if (impaired && _impair(worker, packet, dest, length)) {
+        return;
+    }
+    worker.iovecs[worker.pending].iov_len = length;
+    worker.pending++;
+}
+
+bool SenderEngine::_impair(Worker &worker, const e131_packet_t &packet, const e131_addr_t &dest, size_t length) {
+    auto chance = [&worker](double probability) {
+        uint64_t x = worker.random_state;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        worker.random_state = x;
+        return (double)(x >> 11) * (1.0 / 9007199254740992.0) < probability;
+    };
+
+    if (impairment.loss > 0.0 && chance(impairment.loss)) {
+        impaired_lost.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    // A newer packet of a held universe is going out, so the held one may follow.
+    for (Worker::Held &held : worker.held) {
+        if (held.packet.frame.universe == packet.frame.universe) {
+            held.release = true;
+        }
+    }
+    if (impairment.reorder > 0.0 && (int)worker.held.size() < MAX_HELD && chance(impairment.reorder)) {
+        worker.held.emplace_back();
+        Worker::Held &held = worker.held.back();
+        std::memcpy(&held.packet, &packet, length);
+        held.dest = dest;
+        held.length = length;
+        held.release = false;
+        impaired_reordered.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void SenderEngine::_release_held(Worker &worker, bool all) {
+    // Rare test-only path, so plain sendto() is fine.
+    for (size_t i = 0; i < worker.held.size();) {
+        Worker::Held &held = worker.held[i];
+        if (!all && !held.release) {
+            ++i;
+            continue;
+        }
+        if (sendto(worker.sockfd, held.packet.raw, held.length, 0, (const struct sockaddr *)&held.dest, sizeof(held.dest)) >= 0) {
+            sent_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        worker.held.erase(worker.held.begin() + i);
+    }
+}
+
+void SenderEngine::_flush(Worker &worker) {
+    if (worker.local_pending) {
+        // One doorbell per batch, not per universe.
+        local_transport.ring();
+        worker.local_pending = false;
+    }
+
+    // Packets already waiting go first so a universe never overtakes itself.
+    if (worker.backlog_count > 0) {
+        _drain_backlog(worker);
+    }
+    const int handled = worker.backlog_count == 0 ? _send_batch(worker) : 0;
+    for (int slot = handled; slot < worker.pending; ++slot) {
+        _defer(worker, slot);
+    }
+    worker.pending = 0;
+
+    if (!worker.held.empty()) {
+        _release_held(worker, false);
+    }
+}
+
+int SenderEngine::_send_batch(Worker &worker) {
+    // Returns how many leading packets were sent, failed or dropped; the rest
+    // met a full socket buffer.
+    int offset = 0;
+    std::chrono::steady_clock::time_point deadline;
+    bool waiting = false;
+    while (offset < worker.pending) {
+        int sent = sendmmsg(worker.sockfd, &worker.msgs[offset], worker.pending - offset, 0);
+        if (sent >= 0) {
+            sent_count.fetch_add(sent, std::memory_order_relaxed);
+            offset += sent;
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            // Skip the packet the kernel refused and keep going with the rest.
+            _send_failed(worker, ntohs(worker.packets[offset].frame.universe));
+            offset++;
+            continue;
+        }
+        if (congestion_policy != CONGESTION_BLOCK) {
+            return offset;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!waiting) {
+            deadline = now + std::chrono::microseconds(block_timeout_us);
+            waiting = true;
+        }
+        const int64_t remaining_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+        struct pollfd pfd = { worker.sockfd, POLLOUT, 0 };
+        struct timespec timeout = { (time_t)(remaining_ns / 1000000000), (long)(remaining_ns % 1000000000) };
+        if (remaining_ns <= 0 || ppoll(&pfd, 1, &timeout, nullptr) == 0) {
+            congestion_dropped.fetch_add(worker.pending - offset, std::memory_order_relaxed);
+            return worker.pending;
+        }
+    }
+    return offset;
+}
+
+void SenderEngine::_defer(Worker &worker, int slot) {
+    const e131_packet_t &packet = worker.packets[slot];
+    const e131_addr_t &dest = worker.dests[slot];
+    const size_t length = worker.iovecs[slot].iov_len;
+    const size_t capacity = worker.backlog.size();
+    if (capacity == 0) {
+        congestion_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const uint16_t universe = ntohs(packet.frame.universe);
+    const bool coalesce = congestion_policy == CONGESTION_COALESCE;
+    if (coalesce && worker.backlog_slots[universe] != 0) {
+        // The newer packet takes the older one's place in line.
+        Worker::Pending &pending = worker.backlog[worker.backlog_slots[universe] - 1];
+        if (pending.dest.sin_addr.s_addr == dest.sin_addr.s_addr && pending.dest.sin_port == dest.sin_port) {
+            std::memcpy(&pending.packet, &packet, length);
+            pending.length = length;
+            coalesced_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    const bool dropping = !worker.backlog_counts.empty();
+    if (dropping && worker.backlog_counts[universe] > 0 &&
+            (worker.backlog_counts[universe] >= universe_backlog || worker.backlog_count == capacity)) {
+        // The universe pays for its own burst: its oldest packet goes rather
+        // than the only pending packet of another universe.
+        _replace_oldest(worker, universe, packet, dest, length);
+        congestion_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (worker.backlog_count == capacity) {
+        _pop_backlog(worker, 1);
+        congestion_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    const size_t tail = (worker.backlog_head + worker.backlog_count) % capacity;
+    Worker::Pending &pending = worker.backlog[tail];
+    std::memcpy(&pending.packet, &packet, length);
+    pending.dest = dest;
+    pending.length = length;
+    pending.next = 0;
+    worker.backlog_count++;
+    if (dropping) {
+        if (worker.backlog_counts[universe]++ == 0) {
+            worker.backlog_oldest[universe] = (uint32_t)tail + 1;
+        } else {
+            worker.backlog[worker.backlog_slots[universe] - 1].next = (uint32_t)tail + 1;
+        }
+    }
+    worker.backlog_slots[universe] = (uint32_t)tail + 1;
+}
+
+void SenderEngine::_replace_oldest(Worker &worker, uint16_t universe, const e131_packet_t &packet, const e131_addr_t &dest, size_t length) {
+    // Every packet of the universe moves up one place in its line, so the
+    // ring keeps its order and nothing else moves.
+    Worker::Pending *pending = &worker.backlog[worker.backlog_oldest[universe] - 1];
+    while (pending->next != 0) {
+        const Worker::Pending &newer = worker.backlog[pending->next - 1];
+        std::memcpy(&pending->packet, &newer.packet, newer.length);
+        pending->dest = newer.dest;
+        pending->length = newer.length;
+        pending = &worker.backlog[pending->next - 1];
+    }
+    std::memcpy(&pending->packet, &packet, length);
+    pending->dest = dest;
+    pending->length = length;
+}
+
+void SenderEngine::_pop_backlog(Worker &worker, size_t count) {
+    const size_t capacity = worker.backlog.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (!worker.backlog_slots.empty()) {
+            // The head is always its universe's oldest packet.
+            const Worker::Pending &head = worker.backlog[worker.backlog_head];
+            const uint16_t universe = ntohs(head.packet.frame.universe);
+            if (worker.backlog_slots[universe] == worker.backlog_head + 1) {
+                worker.backlog_slots[universe] = 0;
+            }
+            if (!worker.backlog_counts.empty()) {
+                worker.backlog_oldest[universe] = head.next;
+                worker.backlog_counts[universe]--;
+            }
+        }
+        worker.backlog_head = (worker.backlog_head + 1) % capacity;
+    }
+    worker.backlog_count -= count;
+}
+
+void SenderEngine::_drain_backlog(Worker &worker) {
+    const size_t capacity = worker.backlog.size();
+    while (worker.backlog_count > 0) {
+        const int batch = (int)std::min<size_t>(worker.backlog_count, SEND_BATCH);
+        for (int i = 0; i < batch; ++i) {
+            Worker::Pending &pending = worker.backlog[(worker.backlog_head + i) % capacity];
+            worker.backlog_iovecs[i].iov_base = pending.packet.raw;
+            worker.backlog_iovecs[i].iov_len = pending.length;
+            std::memset(&worker.backlog_msgs[i], 0, sizeof(worker.backlog_msgs[i]));
+            worker.backlog_msgs[i].msg_hdr.msg_iov = &worker.backlog_iovecs[i];
+            worker.backlog_msgs[i].msg_hdr.msg_iovlen = 1;
+            worker.backlog_msgs[i].msg_hdr.msg_name = &pending.dest;
+            worker.backlog_msgs[i].msg_hdr.msg_namelen = sizeof(pending.dest);
+        }
+
+        int sent = sendmmsg(worker.sockfd, worker.backlog_msgs, batch, 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            _send_failed(worker, ntohs(worker.backlog[worker.backlog_head].packet.frame.universe));
+            sent = 1; // give up on it
+        } else {
+            sent_count.fetch_add(sent, std::memory_order_relaxed);
+        }
+        _pop_backlog(worker, sent);
+    }
+}
+
+void SenderEngine::_send_failed(Worker &worker, uint16_t universe) {
+    // A dead link fails every packet, so report at most once a second.
+    const int error = errno;
+    send_errors.fetch_add(1, std::memory_order_relaxed);
+    worker.unlogged_errors++;
+    const auto now = std::chrono::steady_clock::now();
+    if (now - worker.last_error_log >= std::chrono::seconds(1)) {
+        log_error("SenderEngine: sendmmsg failed for universe %u: %s (%llu failures since the last report)",
+                universe, strerror(error), (unsigned long long)worker.unlogged_errors);
+        worker.last_error_log = now;
+        worker.unlogged_errors = 0;
+    }
+}
+
+}
@@ -0,0 +1,299 @@
+#ifndef SENDER_ENGINE_HPP
+#define SENDER_ENGINE_HPP
+
+#include "e131.h"
+#include "local_transport.hpp"
+#include "mpsc_queue.hpp"
+#include "net_interface.hpp"
+#include "output_stage.hpp"
+#include "thread_tuning.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+namespace gacn {
+
+// Where and how a submitted universe should be transmitted.
+struct SendTarget {
+    bool multicast = true;
+    uint32_t unicast_addr = 0; // network byte order, ignored for multicast
+    uint16_t port = 5568;
+    bool preview = false;
+    uint8_t priority = 100;
+    bool network = true; // send over UDP; local transport output is separate
+};
+
+// What a worker does with packets its non-blocking socket would not take.
+enum CongestionPolicy {
+    CONGESTION_COALESCE, // keep only the newest packet per universe in the backlog
+    CONGESTION_DROP_OLDEST, // keep packets in order, dropping a universe's oldest when it has too many waiting
+    CONGESTION_BLOCK, // wait for the socket up to the block timeout, then drop the rest of the batch
+};
+
+// One universe worth of DMX data waiting for the sender thread.
+struct OutboundFrame {
+    SendTarget target;
+    uint16_t universe;
+    uint16_t length;
+    uint8_t data[512];
+};
+
+// Godot-independent sACN transmitter.
+//
+// Any number of threads may call submit(); frames are copied into a bounded
+// lock-free queue and a sender thread builds and sends the packets. With more
+// than one worker, universes are partitioned by universe % worker_count and
+// every worker has its own queue, socket, packet batch and sequence numbers,
+// so a universe is always built by the same thread and stays in order.
+// With several network interfaces every interface gets worker_count workers
+// of its own, with sockets bound to it, and each universe is sent on the
+// interface it is assigned to. Producers never share mutable state with the
+// workers, and stop() waits for producers still inside submit() before the
+// worker table may change.
+//
+// Worker sockets are non-blocking. When the kernel refuses a packet because
+// the socket buffer is full, the congestion policy decides whether it waits
+// in a bounded backlog or is dropped, so a congested link costs stale packets
+// rather than a stalled worker and a full submit queue.
+class SenderEngine {
+public:
+    static const size_t DEFAULT_QUEUE_CAPACITY = 1024;
+    static const uint16_t MAX_UNIVERSE = 63999;
+    static const int SEND_BATCH = 32;
+    static const int MAX_WORKERS = 16;
+    static const int MAX_HELD = 64;
+    static const int MAX_INTERFACES = 8;
+    static const int DEFAULT_BACKLOG = 512;
+    static const int DEFAULT_UNIVERSE_BACKLOG = 4;
+    static const int DEFAULT_BLOCK_TIMEOUT_US = 5000;
+
+    // Synthetic network faults for load testing, applied after sequencing so
+    // receivers see real gaps and late packets. All zero in normal use.
+    struct Impairment {
+        double loss = 0.0; // probability a packet is silently dropped
+        double reorder = 0.0; // probability a packet is held back until its universe's next packet went out
+        uint64_t seed = 1;
+    };
+
+    SenderEngine();
+    ~SenderEngine();
+
+    SenderEngine(const SenderEngine &) = delete;
+    SenderEngine &operator=(const SenderEngine &) = delete;
+
+    // Opens the sockets and starts the sender threads. The queue capacity is
+    // per worker.
+    bool start(size_t queue_capacity = DEFAULT_QUEUE_CAPACITY);
+    // Sends whatever is still queued, then joins the sender threads.
+    void stop();
+    bool is_running() const;
+
+    // Must be called before start().
+    void set_source_name(const char *name);
+    // Worker i is pinned to cpu + i.
+    void set_thread_cpu(int cpu);
+    // CPU pinning (as above), scheduling, socket options and spin-then-block
+    // waiting for the worker threads.
+    void set_latency_tuning(const LatencyTuning &p_tuning);
+    LatencyTuning get_latency_tuning() const;
+    // TuningOption bits the OS refused since the last start().
+    uint32_t get_denied_tuning() const;
+    // Workers per interface.
+    void set_worker_count(int count);
+    int get_worker_count() const;
+    // Interfaces to send on, at most MAX_INTERFACES; an empty list means the
+    // default interface. Universes are sent on interface 0 unless assigned
+    // otherwise. Both apply from the next start(), and a universe keeps its
+    // sequence numbers when it moves.
+    void set_interfaces(const std::vector<NetInterface> &p_interfaces);
+    const std::vector<NetInterface> &get_interfaces() const;
+    bool set_universe_interface(uint16_t universe, int interface);
+    int get_universe_interface(uint16_t universe) const;
+    // Also publishes every frame to the shared-memory table of `port` for
+    // receivers on this machine. Pass 0 to disable.
+    void set_local_transport_port(uint16_t port);
+    uint16_t get_local_transport_port() const;
+    void set_impairment(const Impairment &p_impairment);
+    // Congestion handling, per worker. The backlog holds up to `backlog`
+    // packets for the coalesce and drop-oldest policies, and drop-oldest
+    // keeps at most `universe_backlog` of them per universe, so one busy
+    // universe only ever drops its own packets. Block waits at most
+    // block_timeout_us per batch. Apply from the next start().
+    void set_congestion_policy(CongestionPolicy policy);
+    CongestionPolicy get_congestion_policy() const;
+    void set_backlog_capacity(int backlog);
+    int get_backlog_capacity() const;
+    void set_universe_backlog(int universe_backlog);
+    int get_universe_backlog() const;
+    void set_block_timeout(int block_timeout_us);
+    int get_block_timeout() const;
+
+    // Thread-safe and lock-free. Returns false if the engine is not running,
+    // the arguments are invalid or the queue is full (the frame is dropped).
+    bool submit(uint16_t universe, const uint8_t *data, uint16_t length, const SendTarget &target);
+
+    // Same as submit(), but the payload is written straight into the queued
+    // frame by fill(uint8_t *data), which must write exactly `length` bytes.
+    template <typename F>
+    bool submit_with(uint16_t universe, uint16_t length, const SendTarget &target, F &&fill) {
+        if (universe < 1 || universe > MAX_UNIVERSE || length < 1 || length > 512) {
+            return false;
+        }
+        // Announce the producer before looking at `running`: stop() clears it
+        // and then waits for the count to drop, so the workers and routes are
+        // never touched by start() while a producer still holds them.
+        producers.fetch_add(1);
+        if (!running.load()) {
+            producers.fetch_sub(1, std::memory_order_release);
+            return false;
+        }
+        Worker &worker = *workers[routes[universe] * workers_per_interface + universe % workers_per_interface];
+        bool pushed = worker.queue->try_push([&](OutboundFrame &frame) {
+            frame.target = target;
+            frame.universe = universe;
+            frame.length = length;
+            fill(frame.data);
+        });
+        if (pushed) {
+            _wake_worker(worker);
+        } else {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        producers.fetch_sub(1, std::memory_order_release);
+        return pushed;
+    }
+
+    uint64_t get_sent_count() const;
+    uint64_t get_dropped_count() const;
+    uint64_t get_local_count() const;
+    // Packets replaced by a newer one of the same universe in the backlog.
+    uint64_t get_coalesced_count() const;
+    // Packets dropped by the congestion policy.
+    uint64_t get_congestion_dropped_count() const;
+    // Packets the kernel rejected for any reason other than a full buffer.
+    uint64_t get_send_error_count() const;
+    uint64_t get_impaired_lost_count() const;
+    uint64_t get_impaired_reordered_count() const;
+
+    // Gamma/LUT, calibration, dimmers and dithering applied on the sender thread.
+    OutputStage &get_output_stage();
+    const OutputStage &get_output_stage() const;
+
+private:
+    // Everything one sender thread touches while building and sending.
+    struct Worker {
+        Worker();
+        ~Worker();
+
+        int index = 0;
+        int interface = 0;
+        std::unique_ptr<MpscQueue<OutboundFrame>> queue;
+        size_t queue_capacity = 0; // as requested from start()
+        std::thread thread;
+        int sockfd = -1;
+
+        // One packet/destination per sendmmsg slot.
+        e131_packet_t packets[SEND_BATCH];
+        e131_addr_t dests[SEND_BATCH];
+        struct iovec iovecs[SEND_BATCH];
+        struct mmsghdr msgs[SEND_BATCH];
+        int pending = 0;
+        bool local_pending = false; // doorbell not rung yet
+        // Only the universes this worker owns are ever advanced.
+        uint8_t sequence_numbers[MAX_UNIVERSE + 1] = {};
+        OutputStage::ThreadState output_state;
+
+        // Impairment state: packets held back for reordering.
+        struct Held {
+            e131_packet_t packet;
+            e131_addr_t dest;
+            size_t length;
+            bool release;
+        };
+        uint64_t random_state = 0;
+        std::vector<Held> held;
+
+        // Congestion backlog: a ring of built packets waiting for the socket.
+        struct Pending {
+            e131_packet_t packet;
+            e131_addr_t dest;
+            size_t length;
+            uint32_t next; // slot + 1 of the universe's next packet, 0 if none
+        };
+        std::vector<Pending> backlog;
+        size_t backlog_head = 0;
+        size_t backlog_count = 0;
+        // Backlog slot + 1 of each universe's newest packet, 0 if none; for
+        // coalescing and dropping the oldest.
+        std::vector<uint32_t> backlog_slots;
+        // Dropping the oldest: each universe's oldest packet and how many it
+        // has waiting.
+        std::vector<uint32_t> backlog_oldest;
+        std::vector<uint16_t> backlog_counts;
+        struct iovec backlog_iovecs[SEND_BATCH];
+        struct mmsghdr backlog_msgs[SEND_BATCH];
+        std::chrono::steady_clock::time_point last_error_log;
+        uint64_t unlogged_errors = 0;
+
+        // Lets the idle thread sleep in poll(), next to its socket when it
+        // has a backlog; producers only write the eventfd when it does.
+        int wake_fd = -1;
+        std::atomic<bool> sleeping{ false };
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    int worker_count = 1;
+    std::vector<NetInterface> interfaces;
+    std::vector<uint8_t> universe_interfaces; // as configured
+    // Used while running: interface of every universe and workers per interface.
+    std::vector<uint8_t> routes;
+    int workers_per_interface = 1;
+    std::atomic<bool> running{ false };
+    std::atomic<int> producers{ 0 }; // submit() calls in flight
+    char source_name[64] = "Godot sACN Sender";
+    uint8_t cid[16]; // random UUID identifying this source
+    LatencyTuning tuning;
+    std::atomic<uint32_t> denied_tuning{ 0 };
+    OutputStage output_stage;
+    uint16_t local_port = 0;
+    LocalTransport local_transport;
+    Impairment impairment;
+    bool impaired = false;
+    CongestionPolicy congestion_policy = CONGESTION_COALESCE;
+    int backlog_capacity = DEFAULT_BACKLOG;
+    int universe_backlog = DEFAULT_UNIVERSE_BACKLOG;
+    int block_timeout_us = DEFAULT_BLOCK_TIMEOUT_US;
+
+    std::atomic<uint64_t> sent_count{ 0 };
+    std::atomic<uint64_t> dropped_count{ 0 };
+    std::atomic<uint64_t> local_count{ 0 };
+    std::atomic<uint64_t> coalesced_count{ 0 };
+    std::atomic<uint64_t> congestion_dropped{ 0 };
+    std::atomic<uint64_t> send_errors{ 0 };
+    std::atomic<uint64_t> impaired_lost{ 0 };
+    std::atomic<uint64_t> impaired_reordered{ 0 };
+
+    bool _open_socket(Worker &worker);
+    void _worker_thread_func(Worker &worker);
+    void _wait_for_work(Worker &worker);
+    void _wake_worker(Worker &worker);
+    void _build_packet(Worker &worker, const OutboundFrame &frame);
+    void _flush(Worker &worker);
+    int _send_batch(Worker &worker);
+    void _defer(Worker &worker, int slot);
+    void _replace_oldest(Worker &worker, uint16_t universe, const e131_packet_t &packet, const e131_addr_t &dest, size_t length);
+    void _drain_backlog(Worker &worker);
+    void _pop_backlog(Worker &worker, size_t count);
+    void _send_failed(Worker &worker, uint16_t universe);
+    bool _impair(Worker &worker, const e131_packet_t &packet, const e131_addr_t &dest, size_t length);
+    void _release_held(Worker &worker, bool all);
+};
+
+}
+
+#endif
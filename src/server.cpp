@@ -0,0 +1,830 @@
+#include "server.hpp"
+#include "receiver.hpp"
+#include "e131.h"
+
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace godot {
+
+SacnServer *SacnServer::singleton = nullptr;
+
+void SacnServer::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("set_sender_worker_count", "count"), &SacnServer::set_sender_worker_count);
+    ClassDB::bind_method(D_METHOD("get_sender_worker_count"), &SacnServer::get_sender_worker_count);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_worker_count", PROPERTY_HINT_RANGE, "1,16,1"), "set_sender_worker_count", "get_sender_worker_count");
+
+    ClassDB::bind_method(D_METHOD("set_sender_interfaces", "interfaces"), &SacnServer::set_sender_interfaces);
+    ClassDB::bind_method(D_METHOD("get_sender_interfaces"), &SacnServer::get_sender_interfaces);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::PACKED_STRING_ARRAY, "sender_interfaces"), "set_sender_interfaces", "get_sender_interfaces");
+    ClassDB::bind_method(D_METHOD("set_sender_universe_interface", "universe_id", "interface"), &SacnServer::set_sender_universe_interface);
+    ClassDB::bind_method(D_METHOD("set_sender_universe_range_interface", "first_universe", "count", "interface"), &SacnServer::set_sender_universe_range_interface);
+    ClassDB::bind_method(D_METHOD("get_sender_universe_interface", "universe_id"), &SacnServer::get_sender_universe_interface);
+
+    ClassDB::bind_method(D_METHOD("set_sender_thread_cpu", "cpu"), &SacnServer::set_sender_thread_cpu);
+    ClassDB::bind_method(D_METHOD("get_sender_thread_cpu"), &SacnServer::get_sender_thread_cpu);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_thread_cpu", PROPERTY_HINT_RANGE, "-1,1023,1"), "set_sender_thread_cpu", "get_sender_thread_cpu");
+
+    ClassDB::bind_method(D_METHOD("set_sender_realtime_priority", "priority"), &SacnServer::set_sender_realtime_priority);
+    ClassDB::bind_method(D_METHOD("get_sender_realtime_priority"), &SacnServer::get_sender_realtime_priority);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_realtime_priority", PROPERTY_HINT_RANGE, "0,99,1"), "set_sender_realtime_priority", "get_sender_realtime_priority");
+
+    ClassDB::bind_method(D_METHOD("set_sender_busy_poll_us", "microseconds"), &SacnServer::set_sender_busy_poll_us);
+    ClassDB::bind_method(D_METHOD("get_sender_busy_poll_us"), &SacnServer::get_sender_busy_poll_us);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_busy_poll_us", PROPERTY_HINT_RANGE, "0,1000000,1,suffix:us"), "set_sender_busy_poll_us", "get_sender_busy_poll_us");
+
+    ClassDB::bind_method(D_METHOD("set_sender_socket_buffer_size", "bytes"), &SacnServer::set_sender_socket_buffer_size);
+    ClassDB::bind_method(D_METHOD("get_sender_socket_buffer_size"), &SacnServer::get_sender_socket_buffer_size);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_socket_buffer_size", PROPERTY_HINT_RANGE, "0,1073741824,1,suffix:B"), "set_sender_socket_buffer_size", "get_sender_socket_buffer_size");
+
+    ClassDB::bind_method(D_METHOD("set_sender_spin_us", "microseconds"), &SacnServer::set_sender_spin_us);
+    ClassDB::bind_method(D_METHOD("get_sender_spin_us"), &SacnServer::get_sender_spin_us);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_spin_us", PROPERTY_HINT_RANGE, "0,1000000,1,suffix:us"), "set_sender_spin_us", "get_sender_spin_us");
+
+    ClassDB::bind_method(D_METHOD("get_sender_denied_tuning"), &SacnServer::get_sender_denied_tuning);
+
+    ClassDB::bind_method(D_METHOD("set_sender_congestion_policy", "policy"), &SacnServer::set_sender_congestion_policy);
+    ClassDB::bind_method(D_METHOD("get_sender_congestion_policy"), &SacnServer::get_sender_congestion_policy);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_congestion_policy", PROPERTY_HINT_ENUM, "Coalesce,Drop Oldest,Block"), "set_sender_congestion_policy", "get_sender_congestion_policy");
+
+    ClassDB::bind_method(D_METHOD("set_sender_backlog_size", "packets"), &SacnServer::set_sender_backlog_size);
+    ClassDB::bind_method(D_METHOD("get_sender_backlog_size"), &SacnServer::get_sender_backlog_size);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_backlog_size", PROPERTY_HINT_RANGE, "0,65536,1"), "set_sender_backlog_size", "get_sender_backlog_size");
+
+    ClassDB::bind_method(D_METHOD("set_sender_universe_backlog_size", "packets"), &SacnServer::set_sender_universe_backlog_size);
+    ClassDB::bind_method(D_METHOD("get_sender_universe_backlog_size"), &SacnServer::get_sender_universe_backlog_size);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_universe_backlog_size", PROPERTY_HINT_RANGE, "1,256,1"), "set_sender_universe_backlog_size", "get_sender_universe_backlog_size");
+
+    ClassDB::bind_method(D_METHOD("set_sender_block_timeout_us", "microseconds"), &SacnServer::set_sender_block_timeout_us);
+    ClassDB::bind_method(D_METHOD("get_sender_block_timeout_us"), &SacnServer::get_sender_block_timeout_us);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "sender_block_timeout_us", PROPERTY_HINT_RANGE, "0,1000000,1,suffix:us"), "set_sender_block_timeout_us", "get_sender_block_timeout_us");
+
+    ClassDB::bind_method(D_METHOD("set_sender_master_dimmer", "value"), &SacnServer::set_sender_master_dimmer);
+    ClassDB::bind_method(D_METHOD("get_sender_master_dimmer"), &SacnServer::get_sender_master_dimmer);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::FLOAT, "sender_master_dimmer", PROPERTY_HINT_RANGE, "0,1,0.001"), "set_sender_master_dimmer", "get_sender_master_dimmer");
+
+    ClassDB::bind_method(D_METHOD("set_sender_temporal_dithering", "enable"), &SacnServer::set_sender_temporal_dithering);
+    ClassDB::bind_method(D_METHOD("get_sender_temporal_dithering"), &SacnServer::get_sender_temporal_dithering);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::BOOL, "sender_temporal_dithering"), "set_sender_temporal_dithering", "get_sender_temporal_dithering");
+
+    ClassDB::bind_method(D_METHOD("set_sender_group_dimmer", "group", "value"), &SacnServer::set_sender_group_dimmer);
+    ClassDB::bind_method(D_METHOD("get_sender_group_dimmer", "group"), &SacnServer::get_sender_group_dimmer);
+    ClassDB::bind_method(D_METHOD("set_sender_universe_group", "universe_id", "group"), &SacnServer::set_sender_universe_group);
+    ClassDB::bind_method(D_METHOD("set_sender_universe_gamma", "universe_id", "gamma"), &SacnServer::set_sender_universe_gamma);
+    ClassDB::bind_method(D_METHOD("set_sender_universe_curve", "universe_id", "curve"), &SacnServer::set_sender_universe_curve);
+    ClassDB::bind_method(D_METHOD("set_sender_universe_16bit_slots", "universe_id", "coarse_slots"), &SacnServer::set_sender_universe_16bit_slots);
+    ClassDB::bind_method(D_METHOD("set_sender_slot_calibration", "universe_id", "first_slot", "gains"), &SacnServer::set_sender_slot_calibration);
+    ClassDB::bind_method(D_METHOD("clear_sender_output_processing", "universe_id"), &SacnServer::clear_sender_output_processing);
+
+    ClassDB::bind_method(D_METHOD("set_receiver_interfaces", "interfaces"), &SacnServer::set_receiver_interfaces);
+    ClassDB::bind_method(D_METHOD("get_receiver_interfaces"), &SacnServer::get_receiver_interfaces);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::PACKED_STRING_ARRAY, "receiver_interfaces"), "set_receiver_interfaces", "get_receiver_interfaces");
+
+    ClassDB::bind_method(D_METHOD("set_receiver_thread_cpu", "cpu"), &SacnServer::set_receiver_thread_cpu);
+    ClassDB::bind_method(D_METHOD("get_receiver_thread_cpu"), &SacnServer::get_receiver_thread_cpu);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "receiver_thread_cpu", PROPERTY_HINT_RANGE, "-1,1023,1"), "set_receiver_thread_cpu", "get_receiver_thread_cpu");
+
+    ClassDB::bind_method(D_METHOD("set_receiver_realtime_priority", "priority"), &SacnServer::set_receiver_realtime_priority);
+    ClassDB::bind_method(D_METHOD("get_receiver_realtime_priority"), &SacnServer::get_receiver_realtime_priority);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "receiver_realtime_priority", PROPERTY_HINT_RANGE, "0,99,1"), "set_receiver_realtime_priority", "get_receiver_realtime_priority");
+
+    ClassDB::bind_method(D_METHOD("set_receiver_busy_poll_us", "microseconds"), &SacnServer::set_receiver_busy_poll_us);
+    ClassDB::bind_method(D_METHOD("get_receiver_busy_poll_us"), &SacnServer::get_receiver_busy_poll_us);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "receiver_busy_poll_us", PROPERTY_HINT_RANGE, "0,1000000,1,suffix:us"), "set_receiver_busy_poll_us", "get_receiver_busy_poll_us");
+
+    ClassDB::bind_method(D_METHOD("set_receiver_socket_buffer_size", "bytes"), &SacnServer::set_receiver_socket_buffer_size);
+    ClassDB::bind_method(D_METHOD("get_receiver_socket_buffer_size"), &SacnServer::get_receiver_socket_buffer_size);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "receiver_socket_buffer_size", PROPERTY_HINT_RANGE, "0,1073741824,1,suffix:B"), "set_receiver_socket_buffer_size", "get_receiver_socket_buffer_size");
+
+    ClassDB::bind_method(D_METHOD("set_receiver_spin_us", "microseconds"), &SacnServer::set_receiver_spin_us);
+    ClassDB::bind_method(D_METHOD("get_receiver_spin_us"), &SacnServer::get_receiver_spin_us);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "receiver_spin_us", PROPERTY_HINT_RANGE, "0,1000000,1,suffix:us"), "set_receiver_spin_us", "get_receiver_spin_us");
+
+    ClassDB::bind_method(D_METHOD("get_receiver_denied_tuning"), &SacnServer::get_receiver_denied_tuning);
+
+    ClassDB::bind_method(D_METHOD("set_receiver_max_sockets", "count"), &SacnServer::set_receiver_max_sockets);
+    ClassDB::bind_method(D_METHOD("get_receiver_max_sockets"), &SacnServer::get_receiver_max_sockets);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "receiver_max_sockets", PROPERTY_HINT_RANGE, "1,1024,1"), "set_receiver_max_sockets", "get_receiver_max_sockets");
+    ClassDB::bind_method(D_METHOD("get_receiver_membership_capacity"), &SacnServer::get_receiver_membership_capacity);
+
+    ClassDB::bind_method(D_METHOD("set_receiver_merge_mode", "mode"), &SacnServer::set_receiver_merge_mode);
+    ClassDB::bind_method(D_METHOD("get_receiver_merge_mode"), &SacnServer::get_receiver_merge_mode);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "receiver_merge_mode", PROPERTY_HINT_ENUM, "Latest,HTP"), "set_receiver_merge_mode", "get_receiver_merge_mode");
+
+    ClassDB::bind_method(D_METHOD("set_receiver_loss_policy", "policy"), &SacnServer::set_receiver_loss_policy);
+    ClassDB::bind_method(D_METHOD("get_receiver_loss_policy"), &SacnServer::get_receiver_loss_policy);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::INT, "receiver_loss_policy", PROPERTY_HINT_ENUM, "Hold,Blackout,Fade"), "set_receiver_loss_policy", "get_receiver_loss_policy");
+
+    ClassDB::bind_method(D_METHOD("set_receiver_fade_time", "seconds"), &SacnServer::set_receiver_fade_time);
+    ClassDB::bind_method(D_METHOD("get_receiver_fade_time"), &SacnServer::get_receiver_fade_time);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::FLOAT, "receiver_fade_time", PROPERTY_HINT_RANGE, "0,60,0.01,suffix:s"), "set_receiver_fade_time", "get_receiver_fade_time");
+
+    ClassDB::bind_method(D_METHOD("set_receiver_source_timeout", "seconds"), &SacnServer::set_receiver_source_timeout);
+    ClassDB::bind_method(D_METHOD("get_receiver_source_timeout"), &SacnServer::get_receiver_source_timeout);
+    ClassDB::add_property("SacnServer", PropertyInfo(Variant::FLOAT, "receiver_source_timeout", PROPERTY_HINT_RANGE, "0.1,60,0.1,suffix:s"), "set_receiver_source_timeout", "get_receiver_source_timeout");
+
+    ClassDB::bind_method(D_METHOD("get_stats"), &SacnServer::get_stats);
+
+    // Targets of call_deferred().
+    ClassDB::bind_method(D_METHOD("_restart_sender_queued"), &SacnServer::_restart_sender_queued);
+    ClassDB::bind_method(D_METHOD("_restart_receiver_queued"), &SacnServer::_restart_receiver_queued);
+}
+
+SacnServer *SacnServer::get_singleton() {
+    return singleton;
+}
+
+SacnServer::SacnServer() : receiver(E131_DEFAULT_PORT) {
+    singleton = this;
+    receiver.set_universe_callback([this](uint16_t universe_id, const uint8_t *data, uint16_t length) {
+        _dispatch_universe(universe_id, data, length);
+    });
+    receiver.set_source_lost_callback([this](const uint8_t *cid, uint16_t universe_id, bool terminated) {
+        _dispatch_source_lost(cid, universe_id, terminated);
+    });
+    receiver.set_universe_lost_callback([this](uint16_t universe_id) {
+        _dispatch_universe_lost(universe_id);
+    });
+}
+
+SacnServer::~SacnServer() {
+    receiver.stop();
+    sender.stop();
+    if (singleton == this) {
+        singleton = nullptr;
+    }
+}
+
+gacn::SenderEngine &SacnServer::get_sender_engine() {
+    return sender;
+}
+
+void SacnServer::attach_sender() {
+    if (sender_users++ == 0) {
+        _apply_sender_settings();
+        sender_restart_queued = false;
+        if (!sender.start()) {
+            UtilityFunctions::printerr("SacnServer: the sender engine failed to start");
+        }
+    }
+}
+
+void SacnServer::detach_sender() {
+    if (sender_users > 0 && --sender_users == 0) {
+        sender.stop();
+    }
+}
+
+void SacnServer::restart_sender() {
+    if (sender_users == 0) {
+        return; // applied on the next start
+    }
+    // Queued frames are sent before the restart.
+    sender.stop();
+    _apply_sender_settings();
+    if (!sender.start()) {
+        UtilityFunctions::printerr("SacnServer: the sender engine failed to restart");
+    }
+}
+
+void SacnServer::_apply_sender_settings() {
+    // Only while stopped: the workers read these without locks.
+    sender.set_worker_count(sender_settings.worker_count);
+    sender.set_interfaces(sender_settings.interfaces);
+    sender.set_latency_tuning(sender_settings.tuning);
+    sender.set_congestion_policy(sender_settings.congestion_policy);
+    sender.set_backlog_capacity(sender_settings.backlog_capacity);
+    sender.set_universe_backlog(sender_settings.universe_backlog);
+    sender.set_block_timeout(sender_settings.block_timeout_us);
+}
+
+void SacnServer::queue_sender_restart() {
+    if (!sender_restart_queued) {
+        sender_restart_queued = true;
+        call_deferred("_restart_sender_queued");
+    }
+}
+
+void SacnServer::_restart_sender_queued() {
+    if (!sender_restart_queued) {
+        return; // already applied by the first sender
+    }
+    sender_restart_queued = false;
+    restart_sender();
+}
+
+void SacnServer::acquire_sender_local_transport(uint16_t port) {
+    sender_local_ports[port]++;
+    _update_sender_local_port();
+}
+
+void SacnServer::release_sender_local_transport(uint16_t port) {
+    auto it = sender_local_ports.find(port);
+    if (it == sender_local_ports.end()) {
+        return;
+    }
+    if (--it->second == 0) {
+        sender_local_ports.erase(it);
+    }
+    _update_sender_local_port();
+}
+
+void SacnServer::_update_sender_local_port() {
+    uint16_t port = sender.get_local_transport_port();
+    if (sender_local_ports.find(port) == sender_local_ports.end()) {
+        port = sender_local_ports.empty() ? 0 : sender_local_ports.begin()->first;
+    }
+    if (sender_local_ports.size() > 1) {
+        UtilityFunctions::printerr("SacnServer: local transport publishes on port ", port, " only; senders on other ports reach local receivers over the network");
+    }
+    if (port != sender.get_local_transport_port()) {
+        sender.set_local_transport_port(port);
+        queue_sender_restart();
+    }
+}
+
+gacn::ReceiverEngine &SacnServer::get_receiver_engine() {
+    return receiver;
+}
+
+bool SacnServer::attach_receiver(SacnReceiver *p_receiver) {
+    {
+        std::lock_guard<std::mutex> lock(receivers_mtx);
+        if (std::find(receivers.begin(), receivers.end(), p_receiver) != receivers.end()) {
+            return true;
+        }
+        receivers.push_back(p_receiver);
+    }
+    if (!receiver.is_running()) {
+        // Settings changed while nobody was receiving go in with the start.
+        _apply_receiver_settings(receiver);
+        receiver_restart_queued = false;
+        if (!receiver.start()) {
+            std::lock_guard<std::mutex> lock(receivers_mtx);
+            receivers.erase(std::find(receivers.begin(), receivers.end(), p_receiver));
+            return false;
+        }
+    }
+    return true;
+}
+
+void SacnServer::detach_receiver(SacnReceiver *p_receiver) {
+    bool last = false;
+    std::vector<uint16_t> unused;
+    {
+        std::lock_guard<std::mutex> lock(receivers_mtx);
+        auto it = std::find(receivers.begin(), receivers.end(), p_receiver);
+        if (it == receivers.end()) {
+            return;
+        }
+        receivers.erase(it);
+        for (auto sub = subscriptions.begin(); sub != subscriptions.end();) {
+            std::vector<SacnReceiver *> &list = sub->second.receivers;
+            list.erase(std::remove(list.begin(), list.end(), p_receiver), list.end());
+            if (list.empty()) {
+                unused.push_back(sub->first);
+                sub = subscriptions.erase(sub);
+            } else {
+                ++sub;
+            }
+        }
+        last = receivers.empty();
+    }
+    // Closing the sockets leaves every group; otherwise leave the ones nobody
+    // listens to anymore, so they can be joined again on another interface.
+    if (last) {
+        receiver.stop();
+        return;
+    }
+    for (uint16_t universe_id : unused) {
+        receiver.get_memberships().leave(universe_id);
+    }
+}
+
+bool SacnServer::is_attached(const SacnReceiver *p_receiver) const {
+    std::lock_guard<std::mutex> lock(receivers_mtx);
+    return std::find(receivers.begin(), receivers.end(), p_receiver) != receivers.end();
+}
+
+void SacnServer::reconfigure_receiver(const std::function<void(gacn::ReceiverEngine &)> &change) {
+    // Stopping joins the receive threads, which may be waiting for receivers_mtx.
+    const bool running = receiver.is_running();
+    receiver.stop();
+    change(receiver);
+    if (running) {
+        if (!receiver.start()) {
+            UtilityFunctions::printerr("SacnServer: the receiver engine failed to restart");
+            return;
+        }
+        _join_subscriptions();
+    }
+}
+
+void SacnServer::queue_receiver_restart() {
+    if (!receiver_restart_queued) {
+        receiver_restart_queued = true;
+        call_deferred("_restart_receiver_queued");
+    }
+}
+
+void SacnServer::_restart_receiver_queued() {
+    if (!receiver_restart_queued) {
+        return; // already applied by a subscription
+    }
+    receiver_restart_queued = false;
+    reconfigure_receiver([this](gacn::ReceiverEngine &engine) {
+        _apply_receiver_settings(engine);
+    });
+}
+
+void SacnServer::_apply_receiver_settings(gacn::ReceiverEngine &engine) {
+    engine.set_interfaces(receiver_settings.interfaces);
+    engine.set_latency_tuning(receiver_settings.tuning);
+    engine.set_local_transport(receiver_local_users > 0);
+}
+
+void SacnServer::acquire_receiver_local_transport() {
+    // Restart to open the shared-memory table
+    if (receiver_local_users++ == 0) {
+        queue_receiver_restart();
+    }
+}
+
+void SacnServer::release_receiver_local_transport() {
+    if (receiver_local_users > 0 && --receiver_local_users == 0) {
+        queue_receiver_restart();
+    }
+}
+
+void SacnServer::_join_subscriptions() {
+    std::vector<std::pair<uint16_t, int>> joins;
+    {
+        std::lock_guard<std::mutex> lock(receivers_mtx);
+        for (const auto &entry : subscriptions) {
+            joins.emplace_back(entry.first, entry.second.interface);
+        }
+    }
+    for (const auto &join : joins) {
+        receiver.get_memberships().join(join.first, join.second);
+    }
+}
+
+bool SacnServer::subscribe(SacnReceiver *p_receiver, uint16_t universe_id, int interface) {
+    return subscribe_range(p_receiver, universe_id, 1, interface) == 1;
+}
+
+int SacnServer::subscribe_range(SacnReceiver *p_receiver, uint16_t first_universe, int count, int interface) {
+    if (!is_attached(p_receiver)) {
+        return 0;
+    }
+    // Interfaces changed this frame must exist before anything joins on them.
+    _restart_receiver_queued();
+    // Failures (including running out of memberships or a universe joined on
+    // another interface) are reported by the manager.
+    gacn::MembershipManager &memberships = receiver.get_memberships();
+    memberships.join_range(first_universe, count, interface);
+
+    int subscribed = 0;
+    std::lock_guard<std::mutex> lock(receivers_mtx);
+    for (int i = 0; i < count && first_universe + i <= 63999; ++i) {
+        const uint16_t universe_id = (uint16_t)(first_universe + i);
+        if (memberships.get_joined_interface(universe_id) != interface) {
+            continue;
+        }
+        Subscription &subscription = subscriptions[universe_id];
+        subscription.interface = interface;
+        std::vector<SacnReceiver *> &list = subscription.receivers;
+        if (std::find(list.begin(), list.end(), p_receiver) == list.end()) {
+            list.push_back(p_receiver);
+        }
+        subscribed++;
+    }
+    return subscribed;
+}
+
+bool SacnServer::is_subscribed(const SacnReceiver *p_receiver, uint16_t universe_id) const {
+    std::lock_guard<std::mutex> lock(receivers_mtx);
+    auto it = subscriptions.find(universe_id);
+    if (it == subscriptions.end()) {
+        return false;
+    }
+    const std::vector<SacnReceiver *> &list = it->second.receivers;
+    return std::find(list.begin(), list.end(), p_receiver) != list.end();
+}
+
+void SacnServer::_dispatch_universe(uint16_t universe_id, const uint8_t *data, uint16_t length) {
+    std::lock_guard<std::mutex> lock(receivers_mtx);
+    auto it = subscriptions.find(universe_id);
+    if (it == subscriptions.end()) {
+        return;
+    }
+    for (SacnReceiver *subscriber : it->second.receivers) {
+        subscriber->_on_universe(universe_id, data, length);
+    }
+}
+
+void SacnServer::_dispatch_source_lost(const uint8_t *cid, uint16_t universe_id, bool terminated) {
+    std::lock_guard<std::mutex> lock(receivers_mtx);
+    auto it = subscriptions.find(universe_id);
+    if (it == subscriptions.end()) {
+        return;
+    }
+    for (SacnReceiver *subscriber : it->second.receivers) {
+        subscriber->_on_source_lost(cid, universe_id, terminated);
+    }
+}
+
+void SacnServer::_dispatch_universe_lost(uint16_t universe_id) {
+    std::lock_guard<std::mutex> lock(receivers_mtx);
+    auto it = subscriptions.find(universe_id);
+    if (it == subscriptions.end()) {
+        return;
+    }
+    for (SacnReceiver *subscriber : it->second.receivers) {
+        subscriber->_on_universe_lost(universe_id);
+    }
+}
+
+bool SacnServer::_resolve_interfaces(const PackedStringArray &p_names, std::vector<gacn::NetInterface> &r_interfaces) {
+    std::vector<std::string> specs;
+    for (int64_t i = 0; i < p_names.size(); ++i) {
+        specs.push_back(p_names[i].utf8().get_data());
+    }
+    // Unknown interfaces are logged by the resolver.
+    return gacn::resolve_interfaces(specs, r_interfaces);
+}
+
+PackedStringArray SacnServer::_tuning_names(uint32_t options) {
+    PackedStringArray names;
+    for (uint32_t bit = 1; bit <= gacn::TUNING_SOCKET_BUFFER; bit <<= 1) {
+        if (options & bit) {
+            names.push_back(gacn::tuning_option_name((gacn::TuningOption)bit));
+        }
+    }
+    return names;
+}
+
+void SacnServer::set_sender_worker_count(int p_count) {
+    p_count = std::clamp(p_count, 1, (int)gacn::SenderEngine::MAX_WORKERS);
+    if (p_count != sender_settings.worker_count) {
+        sender_settings.worker_count = p_count;
+        queue_sender_restart();
+    }
+}
+
+int SacnServer::get_sender_worker_count() const {
+    return sender_settings.worker_count;
+}
+
+void SacnServer::set_sender_interfaces(const PackedStringArray &p_interfaces) {
+    // Keep the current interfaces if any name does not resolve.
+    std::vector<gacn::NetInterface> resolved;
+    if (!_resolve_interfaces(p_interfaces, resolved)) {
+        return;
+    }
+    if (resolved.size() > (size_t)gacn::SenderEngine::MAX_INTERFACES) {
+        UtilityFunctions::printerr("SacnServer: only the first ", gacn::SenderEngine::MAX_INTERFACES, " sender interfaces are used");
+        resolved.resize(gacn::SenderEngine::MAX_INTERFACES);
+    }
+    sender_settings.interface_names = p_interfaces;
+    sender_settings.interfaces = resolved;
+    queue_sender_restart();
+}
+
+PackedStringArray SacnServer::get_sender_interfaces() const {
+    return sender_settings.interface_names;
+}
+
+void SacnServer::set_sender_universe_interface(int universe_id, int interface) {
+    set_sender_universe_range_interface(universe_id, 1, interface);
+}
+
+void SacnServer::set_sender_universe_range_interface(int first_universe, int count, int interface) {
+    if (first_universe < 1 || count < 1 || first_universe + count - 1 > gacn::SenderEngine::MAX_UNIVERSE) {
+        UtilityFunctions::printerr("SacnServer: invalid universe range ", first_universe, " + ", count);
+        return;
+    }
+    const int interface_count = std::max((int)sender_settings.interfaces.size(), 1);
+    if (interface < 0 || interface >= interface_count) {
+        UtilityFunctions::printerr("SacnServer: interface must be between 0 and ", interface_count - 1);
+        return;
+    }
+    // The engine only reads the assignments at start; every assignment made
+    // this frame goes in with the same restart.
+    for (int i = 0; i < count; ++i) {
+        sender.set_universe_interface((uint16_t)(first_universe + i), interface);
+    }
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_universe_interface(int universe_id) const {
+    if (universe_id < 1 || universe_id > gacn::SenderEngine::MAX_UNIVERSE) {
+        return 0;
+    }
+    return sender.get_universe_interface(universe_id);
+}
+
+void SacnServer::set_sender_thread_cpu(int p_cpu) {
+    sender_settings.tuning.cpu = p_cpu;
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_thread_cpu() const {
+    return sender_settings.tuning.cpu;
+}
+
+void SacnServer::set_sender_realtime_priority(int p_priority) {
+    sender_settings.tuning.realtime_priority = p_priority;
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_realtime_priority() const {
+    return sender_settings.tuning.realtime_priority;
+}
+
+void SacnServer::set_sender_busy_poll_us(int p_microseconds) {
+    sender_settings.tuning.busy_poll_us = p_microseconds;
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_busy_poll_us() const {
+    return sender_settings.tuning.busy_poll_us;
+}
+
+void SacnServer::set_sender_socket_buffer_size(int p_bytes) {
+    sender_settings.tuning.socket_buffer = p_bytes;
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_socket_buffer_size() const {
+    return sender_settings.tuning.socket_buffer;
+}
+
+void SacnServer::set_sender_spin_us(int p_microseconds) {
+    sender_settings.tuning.spin_us = p_microseconds;
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_spin_us() const {
+    return sender_settings.tuning.spin_us;
+}
+
+PackedStringArray SacnServer::get_sender_denied_tuning() const {
+    return _tuning_names(sender.get_denied_tuning());
+}
+
+void SacnServer::set_sender_congestion_policy(int p_policy) {
+    const gacn::CongestionPolicy policy = p_policy == gacn::CONGESTION_BLOCK ? gacn::CONGESTION_BLOCK :
+            (p_policy == gacn::CONGESTION_DROP_OLDEST ? gacn::CONGESTION_DROP_OLDEST : gacn::CONGESTION_COALESCE);
+    if (policy != sender_settings.congestion_policy) {
+        sender_settings.congestion_policy = policy;
+        queue_sender_restart();
+    }
+}
+
+int SacnServer::get_sender_congestion_policy() const {
+    return sender_settings.congestion_policy;
+}
+
+void SacnServer::set_sender_backlog_size(int p_packets) {
+    sender_settings.backlog_capacity = std::clamp(p_packets, 0, 65536);
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_backlog_size() const {
+    return sender_settings.backlog_capacity;
+}
+
+void SacnServer::set_sender_universe_backlog_size(int p_packets) {
+    sender_settings.universe_backlog = std::clamp(p_packets, 1, 256);
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_universe_backlog_size() const {
+    return sender_settings.universe_backlog;
+}
+
+void SacnServer::set_sender_block_timeout_us(int p_microseconds) {
+    sender_settings.block_timeout_us = std::max(p_microseconds, 0);
+    queue_sender_restart();
+}
+
+int SacnServer::get_sender_block_timeout_us() const {
+    return sender_settings.block_timeout_us;
+}
+
+void SacnServer::set_sender_master_dimmer(float p_value) {
+    sender.get_output_stage().set_master_dimmer(p_value);
+}
+
+float SacnServer::get_sender_master_dimmer() const {
+    return sender.get_output_stage().get_master_dimmer();
+}
+
+void SacnServer::set_sender_temporal_dithering(bool p_enable) {
+    sender.get_output_stage().set_dithering(p_enable);
+}
+
+bool SacnServer::get_sender_temporal_dithering() const {
+    return sender.get_output_stage().get_dithering();
+}
+
+void SacnServer::set_sender_group_dimmer(int group, float value) {
+    if (group < 0 || group >= gacn::OutputStage::MAX_GROUPS) {
+        UtilityFunctions::printerr("SacnServer: group must be between 0 and ", gacn::OutputStage::MAX_GROUPS - 1);
+        return;
+    }
+    sender.get_output_stage().set_group_dimmer(group, value);
+}
+
+float SacnServer::get_sender_group_dimmer(int group) const {
+    return sender.get_output_stage().get_group_dimmer(group);
+}
+
+void SacnServer::set_sender_universe_group(int universe_id, int group) {
+    sender.get_output_stage().set_universe_group(universe_id, group);
+}
+
+void SacnServer::set_sender_universe_gamma(int universe_id, float gamma) {
+    sender.get_output_stage().set_universe_gamma(universe_id, gamma);
+}
+
+void SacnServer::set_sender_universe_curve(int universe_id, const PackedFloat32Array &curve) {
+    if (curve.size() < 2) {
+        UtilityFunctions::printerr("SacnServer: a curve needs at least 2 points");
+        return;
+    }
+    sender.get_output_stage().set_universe_curve(universe_id, curve.ptr(), curve.size());
+}
+
+void SacnServer::set_sender_universe_16bit_slots(int universe_id, const PackedInt32Array &coarse_slots) {
+    std::vector<uint16_t> slots;
+    for (int64_t i = 0; i < coarse_slots.size(); ++i) {
+        if (coarse_slots[i] < 0 || coarse_slots[i] > 510) {
+            UtilityFunctions::printerr("SacnServer: ignoring invalid 16-bit slot ", coarse_slots[i]);
+            continue;
+        }
+        slots.push_back(coarse_slots[i]);
+    }
+    sender.get_output_stage().set_universe_wide_channels(universe_id, slots.data(), slots.size());
+}
+
+void SacnServer::set_sender_slot_calibration(int universe_id, int first_slot, const PackedFloat32Array &gains) {
+    if (first_slot < 0 || first_slot > 511) {
+        UtilityFunctions::printerr("SacnServer: invalid first slot ", first_slot);
+        return;
+    }
+    sender.get_output_stage().set_channel_gains(universe_id, first_slot, gains.ptr(), gains.size());
+}
+
+void SacnServer::clear_sender_output_processing(int universe_id) {
+    sender.get_output_stage().clear_universe(universe_id);
+}
+
+void SacnServer::set_receiver_interfaces(const PackedStringArray &p_interfaces) {
+    // Keep the current interfaces if any name does not resolve.
+    std::vector<gacn::NetInterface> resolved;
+    if (!_resolve_interfaces(p_interfaces, resolved)) {
+        return;
+    }
+    receiver_settings.interface_names = p_interfaces;
+    receiver_settings.interfaces = resolved;
+    queue_receiver_restart();
+}
+
+PackedStringArray SacnServer::get_receiver_interfaces() const {
+    return receiver_settings.interface_names;
+}
+
+void SacnServer::set_receiver_thread_cpu(int p_cpu) {
+    receiver_settings.tuning.cpu = p_cpu;
+    queue_receiver_restart();
+}
+
+int SacnServer::get_receiver_thread_cpu() const {
+    return receiver_settings.tuning.cpu;
+}
+
+void SacnServer::set_receiver_realtime_priority(int p_priority) {
+    receiver_settings.tuning.realtime_priority = p_priority;
+    queue_receiver_restart();
+}
+
+int SacnServer::get_receiver_realtime_priority() const {
+    return receiver_settings.tuning.realtime_priority;
+}
+
+void SacnServer::set_receiver_busy_poll_us(int p_microseconds) {
+    receiver_settings.tuning.busy_poll_us = p_microseconds;
+    queue_receiver_restart();
+}
+
+int SacnServer::get_receiver_busy_poll_us() const {
+    return receiver_settings.tuning.busy_poll_us;
+}
+
+void SacnServer::set_receiver_socket_buffer_size(int p_bytes) {
+    receiver_settings.tuning.socket_buffer = p_bytes;
+    queue_receiver_restart();
+}
+
+int SacnServer::get_receiver_socket_buffer_size() const {
+    return receiver_settings.tuning.socket_buffer;
+}
+
+void SacnServer::set_receiver_spin_us(int p_microseconds) {
+    receiver_settings.tuning.spin_us = p_microseconds;
+    queue_receiver_restart();
+}
+
+int SacnServer::get_receiver_spin_us() const {
+    return receiver_settings.tuning.spin_us;
+}
+
+PackedStringArray SacnServer::get_receiver_denied_tuning() const {
+    return _tuning_names(receiver.get_denied_tuning());
+}
+
+void SacnServer::set_receiver_max_sockets(int p_count) {
+    receiver.get_memberships().set_max_sockets(p_count);
+}
+
+int SacnServer::get_receiver_max_sockets() const {
+    return receiver.get_memberships().get_max_sockets();
+}
+
+Dictionary SacnServer::get_receiver_membership_capacity() const {
+    gacn::MembershipManager::Capacity capacity = receiver.get_memberships().get_capacity();
+    Dictionary result;
+    result["interfaces"] = capacity.interfaces;
+    result["sockets"] = capacity.sockets;
+    result["max_sockets"] = capacity.max_sockets;
+    result["per_socket"] = capacity.per_socket;
+    result["joined"] = capacity.joined;
+    result["capacity"] = capacity.capacity;
+    return result;
+}
+
+void SacnServer::set_receiver_merge_mode(int p_mode) {
+    receiver.set_merge_mode(p_mode == gacn::MERGE_HTP ? gacn::MERGE_HTP : gacn::MERGE_LATEST);
+}
+
+int SacnServer::get_receiver_merge_mode() const {
+    return receiver.get_merge_mode();
+}
+
+void SacnServer::set_receiver_loss_policy(int p_policy) {
+    receiver.set_loss_policy(p_policy == gacn::LOSS_FADE ? gacn::LOSS_FADE : (p_policy == gacn::LOSS_BLACKOUT ? gacn::LOSS_BLACKOUT : gacn::LOSS_HOLD));
+}
+
+int SacnServer::get_receiver_loss_policy() const {
+    return receiver.get_loss_policy();
+}
+
+void SacnServer::set_receiver_fade_time(double p_seconds) {
+    receiver.set_fade_time((uint64_t)(std::max(p_seconds, 0.0) * 1e9));
+}
+
+double SacnServer::get_receiver_fade_time() const {
+    return receiver.get_fade_time() / 1e9;
+}
+
+void SacnServer::set_receiver_source_timeout(double p_seconds) {
+    receiver.set_source_timeout((uint64_t)(std::max(p_seconds, 0.1) * 1e9));
+}
+
+double SacnServer::get_receiver_source_timeout() const {
+    return receiver.get_source_timeout() / 1e9;
+}
+
+Dictionary SacnServer::get_stats() const {
+    Dictionary result;
+    {
+        std::lock_guard<std::mutex> lock(receivers_mtx);
+        result["receivers"] = (int64_t)receivers.size();
+        result["subscribed_universes"] = (int64_t)subscriptions.size();
+    }
+    result["senders"] = sender_users;
+    result["sent_packets"] = (int64_t)sender.get_sent_count();
+    // Frames dropped because a submit queue was full.
+    result["dropped_packets"] = (int64_t)sender.get_dropped_count();
+    result["local_packets"] = (int64_t)sender.get_local_count();
+    result["coalesced_packets"] = (int64_t)sender.get_coalesced_count();
+    // Packets dropped by the congestion policy.
+    result["congestion_dropped_packets"] = (int64_t)sender.get_congestion_dropped_count();
+    result["send_errors"] = (int64_t)sender.get_send_error_count();
+
+    const gacn::ReceiverEngine::Stats stats = receiver.get_stats();
+    result["received_packets"] = (int64_t)stats.packets;
+    result["invalid_packets"] = (int64_t)stats.invalid;
+    result["not_joined_packets"] = (int64_t)stats.not_joined;
+    result["out_of_order_packets"] = (int64_t)stats.out_of_order;
+    result["sources_lost"] = (int64_t)stats.sources_lost;
+    result["sources_terminated"] = (int64_t)stats.sources_terminated;
+    return result;
+}
+
+}
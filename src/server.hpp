@@ -0,0 +1,233 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+
+#include "receiver_engine.hpp"
+#include "sender_engine.hpp"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace godot {
+
+class SacnReceiver;
+
+// Engine singleton owning the sACN I/O for the whole process: one sender
+// engine with its workers and sockets, and one receiver engine with its
+// socket pool and receive threads. SacnSender and SacnReceiver nodes are
+// handles onto it, so a scene with many nodes still makes one set of
+// batched syscalls and receivers never fight over the port.
+//
+// Each engine runs while at least one node uses it. Everything the nodes
+// share lives here rather than on the nodes: output processing, merging and
+// loss handling apply at once, and settings that need an engine restart
+// (workers, interfaces, tuning, congestion handling) are applied by one
+// restart at the end of the frame, however many changed. Received universes
+// are handed to every receiver subscribed to them, on the receive thread.
+class SacnServer : public Object {
+    GDCLASS(SacnServer, Object);
+
+    static SacnServer *singleton;
+
+private:
+    struct Subscription {
+        int interface = 0;
+        std::vector<SacnReceiver *> receivers;
+    };
+
+    // Settings waiting for the next engine start; the engines' threads read
+    // their own copies while running.
+    struct SenderSettings {
+        int worker_count = 1;
+        PackedStringArray interface_names;
+        std::vector<gacn::NetInterface> interfaces;
+        gacn::LatencyTuning tuning;
+        gacn::CongestionPolicy congestion_policy = gacn::CONGESTION_COALESCE;
+        int backlog_capacity = gacn::SenderEngine::DEFAULT_BACKLOG;
+        int universe_backlog = gacn::SenderEngine::DEFAULT_UNIVERSE_BACKLOG;
+        int block_timeout_us = gacn::SenderEngine::DEFAULT_BLOCK_TIMEOUT_US;
+    };
+    struct ReceiverSettings {
+        PackedStringArray interface_names;
+        std::vector<gacn::NetInterface> interfaces;
+        gacn::LatencyTuning tuning;
+    };
+
+    gacn::SenderEngine sender;
+    SenderSettings sender_settings;
+    int sender_users = 0;
+    bool sender_restart_queued = false;
+    // Senders publishing to local receivers, counted per port. The engine
+    // publishes on one port: the one in use while anyone wants it, else the
+    // lowest one asked for.
+    std::map<uint16_t, int> sender_local_ports;
+
+    gacn::ReceiverEngine receiver;
+    ReceiverSettings receiver_settings;
+    bool receiver_restart_queued = false;
+    int receiver_local_users = 0;
+    // Guards the tables below; held by the receive thread while it hands a
+    // universe to the subscribers, so a detached receiver is never called.
+    mutable std::mutex receivers_mtx;
+    std::vector<SacnReceiver *> receivers;
+    std::unordered_map<uint16_t, Subscription> subscriptions;
+
+    void _dispatch_universe(uint16_t universe_id, const uint8_t *data, uint16_t length);
+    void _dispatch_source_lost(const uint8_t *cid, uint16_t universe_id, bool terminated);
+    void _dispatch_universe_lost(uint16_t universe_id);
+    void _join_subscriptions();
+    void _apply_sender_settings();
+    void _apply_receiver_settings(gacn::ReceiverEngine &engine);
+    void _restart_sender_queued();
+    void _restart_receiver_queued();
+    void _update_sender_local_port();
+    static bool _resolve_interfaces(const PackedStringArray &p_names, std::vector<gacn::NetInterface> &r_interfaces);
+    static PackedStringArray _tuning_names(uint32_t options);
+
+protected:
+    static void _bind_methods();
+
+public:
+    static SacnServer *get_singleton();
+
+    SacnServer();
+    ~SacnServer();
+
+    // Sender side. The engine starts with the first attached sender and
+    // stops with the last; restart_sender() applies changed engine settings
+    // after sending whatever is queued.
+    gacn::SenderEngine &get_sender_engine();
+    void attach_sender();
+    void detach_sender();
+    void restart_sender();
+    // Restarts the sender once at the end of the frame, however many changes
+    // asked for it before then.
+    void queue_sender_restart();
+    // Local transport stays on while any sender wants it.
+    void acquire_sender_local_transport(uint16_t port);
+    void release_sender_local_transport(uint16_t port);
+
+    // Sender engine settings. Interfaces are given by name, index or
+    // address, empty meaning the default one; each gets worker_count workers
+    // and sockets of its own, and universes go out on interface 0 of the list
+    // unless assigned to another. thread_cpu pins worker i to thread_cpu + i;
+    // tuning options the OS refused are logged and listed by
+    // get_sender_denied_tuning(). The congestion policy decides what workers
+    // do when the network cannot keep up: keep the newest packet per
+    // universe, keep packets in order and drop the oldest (at most
+    // universe_backlog_size per universe), or wait up to block_timeout_us.
+    // Sends never block the calling thread.
+    void set_sender_worker_count(int p_count);
+    int get_sender_worker_count() const;
+    void set_sender_interfaces(const PackedStringArray &p_interfaces);
+    PackedStringArray get_sender_interfaces() const;
+    void set_sender_universe_interface(int universe_id, int interface);
+    void set_sender_universe_range_interface(int first_universe, int count, int interface);
+    int get_sender_universe_interface(int universe_id) const;
+    void set_sender_thread_cpu(int p_cpu);
+    int get_sender_thread_cpu() const;
+    void set_sender_realtime_priority(int p_priority);
+    int get_sender_realtime_priority() const;
+    void set_sender_busy_poll_us(int p_microseconds);
+    int get_sender_busy_poll_us() const;
+    void set_sender_socket_buffer_size(int p_bytes);
+    int get_sender_socket_buffer_size() const;
+    void set_sender_spin_us(int p_microseconds);
+    int get_sender_spin_us() const;
+    PackedStringArray get_sender_denied_tuning() const;
+    void set_sender_congestion_policy(int p_policy);
+    int get_sender_congestion_policy() const;
+    void set_sender_backlog_size(int p_packets);
+    int get_sender_backlog_size() const;
+    void set_sender_universe_backlog_size(int p_packets);
+    int get_sender_universe_backlog_size() const;
+    void set_sender_block_timeout_us(int p_microseconds);
+    int get_sender_block_timeout_us() const;
+
+    // Output processing, applied once per transmitted packet of every
+    // sender. Slots are 0-based.
+    void set_sender_master_dimmer(float p_value);
+    float get_sender_master_dimmer() const;
+    void set_sender_temporal_dithering(bool p_enable);
+    bool get_sender_temporal_dithering() const;
+    void set_sender_group_dimmer(int group, float value);
+    float get_sender_group_dimmer(int group) const;
+    void set_sender_universe_group(int universe_id, int group);
+    void set_sender_universe_gamma(int universe_id, float gamma);
+    void set_sender_universe_curve(int universe_id, const PackedFloat32Array &curve);
+    void set_sender_universe_16bit_slots(int universe_id, const PackedInt32Array &coarse_slots);
+    void set_sender_slot_calibration(int universe_id, int first_slot, const PackedFloat32Array &gains);
+    void clear_sender_output_processing(int universe_id);
+
+    // Receiver side. The engine starts with the first attached receiver and
+    // stops with the last. reconfigure_receiver() stops it if running, lets
+    // `change` alter the engine, then restarts it and joins every subscribed
+    // universe again.
+    gacn::ReceiverEngine &get_receiver_engine();
+    bool attach_receiver(SacnReceiver *p_receiver);
+    void detach_receiver(SacnReceiver *p_receiver);
+    bool is_attached(const SacnReceiver *p_receiver) const;
+    void reconfigure_receiver(const std::function<void(gacn::ReceiverEngine &)> &change);
+    // Restarts the receiver once at the end of the frame, or before the next
+    // subscription if that comes first.
+    void queue_receiver_restart();
+    // Local transport stays on while any receiver wants it.
+    void acquire_receiver_local_transport();
+    void release_receiver_local_transport();
+
+    // Receiver engine settings. Interfaces are given as for the sender; each
+    // gets its own socket pool and receive thread, and subscribed universes
+    // are joined again on their interface after a restart. thread_cpu pins
+    // receive thread i to thread_cpu + i.
+    void set_receiver_interfaces(const PackedStringArray &p_interfaces);
+    PackedStringArray get_receiver_interfaces() const;
+    void set_receiver_thread_cpu(int p_cpu);
+    int get_receiver_thread_cpu() const;
+    void set_receiver_realtime_priority(int p_priority);
+    int get_receiver_realtime_priority() const;
+    void set_receiver_busy_poll_us(int p_microseconds);
+    int get_receiver_busy_poll_us() const;
+    void set_receiver_socket_buffer_size(int p_bytes);
+    int get_receiver_socket_buffer_size() const;
+    void set_receiver_spin_us(int p_microseconds);
+    int get_receiver_spin_us() const;
+    PackedStringArray get_receiver_denied_tuning() const;
+
+    // Socket pool size per interface, merging and source loss handling for
+    // every receiver. These apply at once.
+    void set_receiver_max_sockets(int p_count);
+    int get_receiver_max_sockets() const;
+    Dictionary get_receiver_membership_capacity() const;
+    void set_receiver_merge_mode(int p_mode);
+    int get_receiver_merge_mode() const;
+    void set_receiver_loss_policy(int p_policy);
+    int get_receiver_loss_policy() const;
+    void set_receiver_fade_time(double p_seconds);
+    double get_receiver_fade_time() const;
+    void set_receiver_source_timeout(double p_seconds);
+    double get_receiver_source_timeout() const;
+
+    // Joins the universes that no one has joined yet and hands them to the
+    // receiver from then on. A universe is joined on one interface only;
+    // subscribing to it on another one fails. subscribe_range() returns how
+    // many universes of the range the receiver now gets.
+    bool subscribe(SacnReceiver *p_receiver, uint16_t universe_id, int interface);
+    int subscribe_range(SacnReceiver *p_receiver, uint16_t first_universe, int count, int interface);
+    bool is_subscribed(const SacnReceiver *p_receiver, uint16_t universe_id) const;
+
+    // Attached nodes and the packet counters of both engines.
+    Dictionary get_stats() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include "slot_diff.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace gacn {
+
+static int popcount64(uint64_t value) {
+    return __builtin_popcountll(value);
+}
+
+static int ctz64(uint64_t value) {
+    return __builtin_ctzll(value);
+}
+
+#if !defined(__SSE2__)
+// One mask bit per byte that differs between two 8-byte words.
+static uint8_t byte_diff_bits(uint64_t a, uint64_t b) {
+    uint64_t x = a ^ b;
+    // Fold every byte down to its lowest bit, then gather those bits.
+    x |= x >> 4;
+    x |= x >> 2;
+    x |= x >> 1;
+    x &= 0x0101010101010101ull;
+    return (uint8_t)((x * 0x0102040810204080ull) >> 56);
+}
+#endif
+
+int diff_slots(const uint8_t *previous, uint16_t previous_length, const uint8_t *current, uint16_t current_length, SlotMask &mask) {
+    std::memset(mask.words, 0, sizeof(mask.words));
+    previous_length = std::min<uint16_t>(previous_length, 512);
+    current_length = std::min<uint16_t>(current_length, 512);
+
+    // Pad both sides to whole blocks so the loops below need no tail handling.
+    uint8_t a[512];
+    uint8_t b[512];
+    const uint16_t length = std::max(previous_length, current_length);
+    const uint16_t padded = (uint16_t)((length + 15) & ~15);
+    std::memcpy(a, previous, previous_length);
+    std::memset(a + previous_length, 0, padded - previous_length);
+    std::memcpy(b, current, current_length);
+    std::memset(b + current_length, 0, padded - current_length);
+
+#if defined(__SSE2__)
+    for (uint16_t offset = 0; offset < padded; offset += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + offset));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + offset));
+        uint32_t equal = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+        uint64_t changed = (~equal) & 0xffffu;
+        mask.words[offset >> 6] |= changed << (offset & 63);
+    }
+#else
+    for (uint16_t offset = 0; offset < padded; offset += 8) {
+        uint64_t wa, wb;
+        std::memcpy(&wa, a + offset, 8);
+        std::memcpy(&wb, b + offset, 8);
+        if (wa != wb) {
+            // Byte order of the loads decides which byte maps to which bit.
+            uint8_t bits = byte_diff_bits(wa, wb);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            uint8_t reversed = 0;
+            for (int i = 0; i < 8; ++i) {
+                reversed |= ((bits >> i) & 1) << (7 - i);
+            }
+            bits = reversed;
+#endif
+            mask.words[offset >> 6] |= (uint64_t)bits << (offset & 63);
+        }
+    }
+#endif
+
+    // A length change alone marks the slots that appeared or disappeared.
+    for (uint16_t slot = std::min(previous_length, current_length); slot < length; ++slot) {
+        mask.words[slot >> 6] |= 1ull << (slot & 63);
+    }
+
+    int count = 0;
+    for (uint64_t word : mask.words) {
+        count += popcount64(word);
+    }
+    return count;
+}
+
+void mask_to_ranges(const SlotMask &mask, std::vector<int32_t> &ranges) {
+    int32_t start = -1;
+    int32_t slot = 0;
+    while (slot < 512) {
+        const int shift = slot & 63;
+        const uint64_t word = mask.words[slot >> 6] >> shift;
+        // Only the low 64 - shift bits are slots; the rest were shifted in.
+        const uint64_t valid = shift == 0 ? ~0ull : (~0ull >> shift);
+        const uint64_t bits = start < 0 ? word : (~word & valid);
+        if (bits == 0) {
+            // The rest of this word continues the current state.
+            slot = (slot | 63) + 1;
+            continue;
+        }
+        slot += ctz64(bits);
+        if (start < 0) {
+            start = slot;
+        } else {
+            ranges.push_back(start);
+            ranges.push_back(slot - start);
+            start = -1;
+        }
+    }
+    if (start >= 0) {
+        ranges.push_back(start);
+        ranges.push_back(512 - start);
+    }
+}
+
+}
@@ -0,0 +1,25 @@
+#ifndef SLOT_DIFF_HPP
+#define SLOT_DIFF_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace gacn {
+
+// Bit i is set when slot i changed; 512 slots in 8 words.
+struct SlotMask {
+    uint64_t words[8];
+};
+
+// Compares two universes and sets a bit for every slot whose value differs.
+// Slots present in only one of them count as changed. Compares 16 bytes at a
+// time with SSE2 where available, 8 bytes at a time otherwise. Returns the
+// number of changed slots.
+int diff_slots(const uint8_t *previous, uint16_t previous_length, const uint8_t *current, uint16_t current_length, SlotMask &mask);
+
+// Appends [first, count] pairs for every run of set bits in the mask.
+void mask_to_ranges(const SlotMask &mask, std::vector<int32_t> &ranges);
+
+}
+
+#endif
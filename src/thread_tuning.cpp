@@ -0,0 +1,126 @@
+#include "thread_tuning.hpp"
+
+#include "sacn_log.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+
+namespace gacn {
+
+const char *tuning_option_name(TuningOption option) {
+    switch (option) {
+        case TUNING_CPU:
+            return "cpu";
+        case TUNING_REALTIME:
+            return "realtime_priority";
+        case TUNING_BUSY_POLL:
+            return "busy_poll_us";
+        case TUNING_SOCKET_BUFFER:
+            return "socket_buffer";
+    }
+    return "";
+}
+
+bool pin_current_thread(int cpu) {
+#if defined(__linux__) && !defined(__ANDROID__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        errno = err;
+        return false;
+    }
+    return true;
+#elif defined(__ANDROID__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+bool set_current_thread_realtime(int priority) {
+#if defined(__linux__)
+    struct sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (err != 0) {
+        errno = err;
+        return false;
+    }
+    return true;
+#else
+    (void)priority;
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+uint32_t apply_thread_tuning(const LatencyTuning &tuning, int cpu, const char *name) {
+    uint32_t denied = 0;
+    if (cpu >= 0 && !pin_current_thread(cpu)) {
+        log_error("%s: could not pin thread to CPU %d: %s", name, cpu, strerror(errno));
+        denied |= TUNING_CPU;
+    }
+    if (tuning.realtime_priority > 0 && !set_current_thread_realtime(tuning.realtime_priority)) {
+        log_error("%s: SCHED_FIFO priority %d denied: %s", name, tuning.realtime_priority, strerror(errno));
+        denied |= TUNING_REALTIME;
+    }
+    return denied;
+}
+
+uint32_t apply_socket_tuning(int fd, const LatencyTuning &tuning, bool receive, const char *name) {
+    uint32_t denied = 0;
+    if (tuning.busy_poll_us > 0) {
+#if defined(SO_BUSY_POLL)
+        int value = tuning.busy_poll_us;
+        if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) < 0) {
+            log_error("%s: SO_BUSY_POLL %d us denied: %s", name, value, strerror(errno));
+            denied |= TUNING_BUSY_POLL;
+        }
+#else
+        log_error("%s: SO_BUSY_POLL is not supported on this platform", name);
+        denied |= TUNING_BUSY_POLL;
+#endif
+    }
+
+    if (tuning.socket_buffer > 0) {
+        const int option = receive ? SO_RCVBUF : SO_SNDBUF;
+        int value = tuning.socket_buffer;
+        bool forced = false;
+#if defined(SO_RCVBUFFORCE)
+        // The FORCE variants ignore net.core.[rw]mem_max but need CAP_NET_ADMIN.
+        forced = setsockopt(fd, SOL_SOCKET, receive ? SO_RCVBUFFORCE : SO_SNDBUFFORCE, &value, sizeof(value)) == 0;
+#endif
+        if (!forced && setsockopt(fd, SOL_SOCKET, option, &value, sizeof(value)) < 0) {
+            log_error("%s: %s %d denied: %s", name, receive ? "SO_RCVBUF" : "SO_SNDBUF", value, strerror(errno));
+            denied |= TUNING_SOCKET_BUFFER;
+        } else {
+            // The kernel silently caps the request; read back what we got.
+            int actual = 0;
+            socklen_t length = sizeof(actual);
+            bool read_back = getsockopt(fd, SOL_SOCKET, option, &actual, &length) == 0;
+#if defined(__linux__)
+            // Linux reports twice the size to account for bookkeeping overhead.
+            actual /= 2;
+#endif
+            if (read_back && actual < value) {
+                log_error("%s: %s capped at %d bytes instead of %d, raise net.core.%s",
+                        name, receive ? "SO_RCVBUF" : "SO_SNDBUF", actual, value, receive ? "rmem_max" : "wmem_max");
+                denied |= TUNING_SOCKET_BUFFER;
+            }
+        }
+    }
+    return denied;
+}
+
+}
@@ -0,0 +1,55 @@
+#ifndef THREAD_TUNING_HPP
+#define THREAD_TUNING_HPP
+
+#include <cstdint>
+
+namespace gacn {
+
+// Low-latency settings for a network thread and its sockets, for dedicated
+// show machines that can trade CPU time for latency. Everything is off by
+// default.
+struct LatencyTuning {
+    int cpu = -1; // pin to this CPU, -1 = no pinning
+    int realtime_priority = 0; // SCHED_FIFO priority 1-99, 0 = normal scheduling
+    int busy_poll_us = 0; // SO_BUSY_POLL on the thread's sockets, 0 = off
+    int socket_buffer = 0; // SO_RCVBUF / SO_SNDBUF in bytes, 0 = OS default
+    int spin_us = 0; // keep polling this long for new work before blocking
+};
+
+// One bit per LatencyTuning option, used to report what the OS refused.
+enum TuningOption {
+    TUNING_CPU = 1 << 0,
+    TUNING_REALTIME = 1 << 1,
+    TUNING_BUSY_POLL = 1 << 2,
+    TUNING_SOCKET_BUFFER = 1 << 3,
+};
+
+// The LatencyTuning field name of an option.
+const char *tuning_option_name(TuningOption option);
+
+// Pins the calling thread to one CPU. Returns false (with errno set) if the
+// OS refuses or the platform does not support it.
+bool pin_current_thread(int cpu);
+// Switches the calling thread to SCHED_FIFO. Returns false (with errno set)
+// if the OS refuses, usually for lack of CAP_SYS_NICE or an RLIMIT_RTPRIO.
+bool set_current_thread_realtime(int priority);
+
+// Apply the thread or socket part of the tuning. Every refusal is logged with
+// the reason, prefixed by `name`; the result is the mask of refused options.
+uint32_t apply_thread_tuning(const LatencyTuning &tuning, int cpu, const char *name);
+// `receive` picks SO_RCVBUF over SO_SNDBUF. A buffer the kernel caps below
+// the requested size counts as refused.
+uint32_t apply_socket_tuning(int fd, const LatencyTuning &tuning, bool receive, const char *name);
+
+// Busy-wait hint for spin loops.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include "timer_wheel.hpp"
+
+namespace gacn {
+
+TimerWheel::TimerWheel(uint64_t tick_ns) :
+        tick_ns(tick_ns > 0 ? tick_ns : 1) {
+    for (auto &level : slots) {
+        for (uint32_t &head : level) {
+            head = NONE;
+        }
+    }
+}
+
+void TimerWheel::reserve(uint32_t p_count) {
+    if (p_count > entries.size()) {
+        entries.resize(p_count);
+    }
+}
+
+void TimerWheel::clear() {
+    clear(0);
+    started = false;
+}
+
+void TimerWheel::clear(uint64_t now_ns) {
+    for (auto &level : slots) {
+        for (uint32_t &head : level) {
+            head = NONE;
+        }
+    }
+    for (Entry &entry : entries) {
+        entry = Entry();
+    }
+    count = 0;
+    current = now_ns / tick_ns;
+    started = true;
+}
+
+void TimerWheel::schedule(uint32_t id, uint64_t deadline_ns) {
+    reserve(id + 1);
+    if (entries[id].level >= 0) {
+        _unlink(id);
+    }
+    entries[id].expires = deadline_ns / tick_ns;
+    if (!started) {
+        // Deadlines are at or after the caller's now, so the first one is a
+        // safe start; anything earlier given before advance() fires with it.
+        started = true;
+        current = entries[id].expires;
+    }
+    _insert(id);
+}
+
+void TimerWheel::cancel(uint32_t id) {
+    if (id < entries.size() && entries[id].level >= 0) {
+        _unlink(id);
+    }
+}
+
+bool TimerWheel::is_scheduled(uint32_t id) const {
+    return id < entries.size() && entries[id].level >= 0;
+}
+
+uint32_t TimerWheel::size() const {
+    return count;
+}
+
+void TimerWheel::_insert(uint32_t id) {
+    Entry &entry = entries[id];
+    if (entry.expires < current) {
+        entry.expires = current;
+    }
+    const uint64_t max_delta = (1ull << (SLOT_BITS * LEVELS)) - 1;
+    if (entry.expires - current > max_delta) {
+        entry.expires = current + max_delta;
+    }
+
+    // The lowest level whose range still covers the delay.
+    const uint64_t delta = entry.expires - current;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    const uint16_t slot = (uint16_t)((entry.expires >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+    uint32_t &head = slots[level][slot];
+    entry.level = (int16_t)level;
+    entry.slot = slot;
+    entry.prev = NONE;
+    entry.next = head;
+    if (head != NONE) {
+        entries[head].prev = id;
+    }
+    head = id;
+    count++;
+}
+
+void TimerWheel::_unlink(uint32_t id) {
+    Entry &entry = entries[id];
+    if (entry.prev != NONE) {
+        entries[entry.prev].next = entry.next;
+    } else {
+        slots[entry.level][entry.slot] = entry.next;
+    }
+    if (entry.next != NONE) {
+        entries[entry.next].prev = entry.prev;
+    }
+    entry.prev = NONE;
+    entry.next = NONE;
+    entry.level = -1;
+    count--;
+}
+
+void TimerWheel::_cascade(int level, uint64_t slot) {
+    // Detach the whole list first; re-inserted entries land on lower levels
+    // (or further out on this one) and must not be visited again.
+    uint32_t id = slots[level][slot];
+    slots[level][slot] = NONE;
+    while (id != NONE) {
+        uint32_t next = entries[id].next;
+        entries[id].level = -1;
+        count--;
+        _insert(id);
+        id = next;
+    }
+}
+
+bool TimerWheel::_cascades_at(uint64_t tick) const {
+    for (int level = 1; level < LEVELS; ++level) {
+        if ((tick & ((1ull << (SLOT_BITS * level)) - 1)) != 0) {
+            break;
+        }
+        if (slots[level][(tick >> (SLOT_BITS * level)) & (SLOTS - 1)] != NONE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t TimerWheel::_next_event(uint64_t from, uint64_t limit) const {
+    // A full turn of a level with nothing to fire or cascade means the level
+    // is empty, so the next level up can be stepped a whole slot at a time.
+    uint64_t tick = from;
+    for (int level = 0; level < LEVELS; ++level) {
+        const uint64_t step = 1ull << (SLOT_BITS * level);
+        tick = (tick + step - 1) & ~(step - 1);
+        for (int i = 0; i < SLOTS; ++i, tick += step) {
+            if (tick > limit) {
+                return tick;
+            }
+            if ((level == 0 && slots[0][tick & (SLOTS - 1)] != NONE) || _cascades_at(tick)) {
+                return tick;
+            }
+        }
+    }
+    return tick;
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace gacn {
+
+// Hierarchical timing wheel: four levels of 64 slots, each level covering 64
+// times the range of the one below. Scheduling and cancelling are O(1) list
+// operations; advance() cascades entries down a level when their slot comes
+// round, so every timer is touched at most once per level. Spans without
+// timers are skipped a whole slot of the lowest non-empty level at a time.
+//
+// Timers are identified by small integer ids chosen by the caller (for
+// example an index into its own pool), and the lists are intrusive over an id
+// table so nothing is allocated after reserve(). Not thread-safe.
+class TimerWheel {
+public:
+    static const uint32_t NONE = 0xffffffffu;
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    explicit TimerWheel(uint64_t tick_ns = 10000000ull);
+
+    // Makes ids [0, count) usable.
+    void reserve(uint32_t count);
+    // Without a time, the wheel starts from the first advance() or deadline
+    // it is given, whatever clock the caller uses.
+    void clear();
+    void clear(uint64_t now_ns);
+
+    // (Re)arms a timer. Deadlines in the past fire on the next advance();
+    // deadlines past the wheel's range (~46 hours at 10 ms) are clamped.
+    void schedule(uint32_t id, uint64_t deadline_ns);
+    void cancel(uint32_t id);
+    bool is_scheduled(uint32_t id) const;
+    uint32_t size() const;
+
+    // Fires every timer due at or before now_ns, calling on_expire(id) once
+    // for each. The callback may schedule or cancel any timer.
+    template <typename F>
+    void advance(uint64_t now_ns, F &&on_expire) {
+        const uint64_t target = now_ns / tick_ns;
+        if (!started) {
+            started = true;
+            current = target;
+        }
+        while (current <= target) {
+            const uint64_t tick = count > 0 ? _next_event(current, target) : target + 1;
+            if (tick > target) {
+                current = target + 1;
+                break;
+            }
+            // Cascades re-insert relative to the tick being processed.
+            current = tick;
+            for (int level = LEVELS - 1; level > 0; --level) {
+                if ((tick & ((1ull << (SLOT_BITS * level)) - 1)) == 0) {
+                    _cascade(level, (tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+                }
+            }
+            current = tick + 1;
+            uint32_t &head = slots[0][tick & (SLOTS - 1)];
+            while (head != NONE) {
+                uint32_t id = head;
+                _unlink(id);
+                on_expire(id);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint64_t expires = 0; // in ticks
+        int16_t level = -1; // -1 when not scheduled
+        uint16_t slot = 0;
+    };
+
+    uint64_t tick_ns;
+    uint64_t current = 0; // first tick not processed yet
+    bool started = false;
+    uint32_t count = 0;
+    std::vector<Entry> entries;
+    uint32_t slots[LEVELS][SLOTS];
+
+    void _insert(uint32_t id);
+    void _unlink(uint32_t id);
+    void _cascade(int level, uint64_t slot);
+    bool _cascades_at(uint64_t tick) const;
+    uint64_t _next_event(uint64_t from, uint64_t limit) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,203 @@
+#include "universe_merger.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+
+namespace gacn {
+
+UniverseMerger::UniverseMerger() {
+}
+
+void UniverseMerger::set_mode(MergeMode p_mode) {
+    mode = p_mode;
+}
+
+MergeMode UniverseMerger::get_mode() const {
+    return mode;
+}
+
+void UniverseMerger::set_source_timeout(uint64_t p_timeout_ns) {
+    // Running timers pick the new value up when they next fire.
+    source_timeout_ns = p_timeout_ns;
+}
+
+uint64_t UniverseMerger::get_source_timeout() const {
+    return source_timeout_ns;
+}
+
+void UniverseMerger::clear() {
+    universes.clear();
+    pool.clear();
+    free_sources.clear();
+    wheel.clear();
+}
+
+int UniverseMerger::get_source_count() const {
+    return (int)(pool.size() - free_sources.size());
+}
+
+UniverseMerger::Result UniverseMerger::_accept(const e131_packet_t &packet, uint64_t now_ns, Output &output, Loss &loss, uint32_t &removed) {
+    const uint16_t universe_id = ntohs(packet.frame.universe);
+    Universe &universe = universes[universe_id];
+    const bool terminated = (packet.frame.options & (1 << E131_OPT_TERMINATED)) != 0;
+
+    uint32_t id = TimerWheel::NONE;
+    for (uint32_t candidate : universe.sources) {
+        if (std::memcmp(pool[candidate].cid, packet.root.cid, sizeof(pool[candidate].cid)) == 0) {
+            id = candidate;
+            break;
+        }
+    }
+
+    if (id == TimerWheel::NONE) {
+        if (terminated) {
+            // Nothing to terminate.
+            return RESULT_IGNORED;
+        }
+        if (!free_sources.empty()) {
+            id = free_sources.back();
+            free_sources.pop_back();
+        } else {
+            id = (uint32_t)pool.size();
+            pool.emplace_back();
+            wheel.reserve((uint32_t)pool.size());
+        }
+        Source &source = pool[id];
+        std::memcpy(source.cid, packet.root.cid, sizeof(source.cid));
+        source.universe = universe_id;
+        source.priority = 0;
+        source.length = 0;
+        universe.sources.push_back(id);
+        wheel.schedule(id, now_ns + source_timeout_ns);
+    } else if (packet.frame.seq_number == pool[id].last_seq) {
+        // A local sender reaches us over both the shared-memory table and
+        // the network, with the same sequence number on each.
+        return RESULT_DUPLICATE;
+    } else if (e131_pkt_discard(&packet, pool[id].last_seq)) {
+        // Discard out-of-order packets, but resync to the sender.
+        pool[id].last_seq = packet.frame.seq_number;
+        return RESULT_DISCARDED;
+    }
+
+    Source &source = pool[id];
+    source.last_seq = packet.frame.seq_number;
+    source.last_seen = now_ns;
+
+    if (terminated) {
+        wheel.cancel(id);
+        _remove(id, true, loss);
+        removed = id;
+        return RESULT_IGNORED;
+    }
+
+    // Only null start code (DMX level) packets carry slot data.
+    if (packet.dmp.prop_val[0] != 0x00) {
+        return RESULT_IGNORED;
+    }
+
+    uint16_t slot_count = ntohs(packet.dmp.prop_val_cnt);
+    slot_count = slot_count > 513 ? 512 : (slot_count > 0 ? slot_count - 1 : 0);
+    source.priority = packet.frame.priority;
+    source.length = slot_count;
+    std::memcpy(source.data, &packet.dmp.prop_val[1], slot_count);
+
+    return _merge(universe, id, output) ? RESULT_MERGED : RESULT_IGNORED;
+}
+
+bool UniverseMerger::_merge(Universe &universe, uint32_t preferred, Output &output) {
+    if (universe.sources.empty()) {
+        return false;
+    }
+
+    // Find the winning priority, and the most recent source holding it.
+    uint8_t top_priority = 0;
+    uint32_t latest = TimerWheel::NONE;
+    int top_count = 0;
+    for (uint32_t id : universe.sources) {
+        const Source &candidate = pool[id];
+        if (latest == TimerWheel::NONE || candidate.priority > top_priority) {
+            top_priority = candidate.priority;
+            latest = id;
+            top_count = 1;
+        } else if (candidate.priority == top_priority) {
+            top_count++;
+            if (candidate.last_seen > pool[latest].last_seen) {
+                latest = id;
+            }
+        }
+    }
+
+    if (preferred != TimerWheel::NONE) {
+        if (pool[preferred].priority < top_priority) {
+            return false;
+        }
+        latest = preferred;
+    }
+
+    if (top_count == 1 || mode == MERGE_LATEST) {
+        output.data = pool[latest].data;
+        output.length = pool[latest].length;
+        return true;
+    }
+
+    // HTP across all sources sharing the top priority.
+    uint16_t length = 0;
+    std::memset(universe.merged, 0, sizeof(universe.merged));
+    for (uint32_t id : universe.sources) {
+        const Source &candidate = pool[id];
+        if (candidate.priority != top_priority) {
+            continue;
+        }
+        for (uint16_t i = 0; i < candidate.length; ++i) {
+            universe.merged[i] = std::max(universe.merged[i], candidate.data[i]);
+        }
+        length = std::max(length, candidate.length);
+    }
+    universe.length = length;
+    output.data = universe.merged;
+    output.length = length;
+    return true;
+}
+
+bool UniverseMerger::_expire_one(uint32_t id, uint64_t now_ns, Loss &loss) {
+    const Source &source = pool[id];
+    if (now_ns < source.last_seen || now_ns - source.last_seen < source_timeout_ns) {
+        // Heard from since the timer was armed, or on a clock running ahead
+        // of this one (a replay handing over to the receive threads).
+        wheel.schedule(id, source.last_seen + source_timeout_ns);
+        return false;
+    }
+    _remove(id, false, loss);
+    return true;
+}
+
+void UniverseMerger::_remove(uint32_t id, bool terminated, Loss &loss) {
+    const Source &source = pool[id];
+    Universe &universe = universes[source.universe];
+
+    uint8_t top_priority = 0;
+    for (uint32_t candidate : universe.sources) {
+        top_priority = std::max(top_priority, pool[candidate].priority);
+    }
+    auto it = std::find(universe.sources.begin(), universe.sources.end(), id);
+    if (it != universe.sources.end()) {
+        *it = universe.sources.back();
+        universe.sources.pop_back();
+    }
+
+    loss.cid = source.cid;
+    loss.universe = source.universe;
+    loss.terminated = terminated;
+    if (universe.sources.empty()) {
+        // The last source's data is what the universe showed.
+        loss.universe_lost = true;
+        loss.output.data = source.data;
+        loss.output.length = source.length;
+    } else if (source.priority >= top_priority) {
+        // The lost source took part in the output; merge what is left.
+        loss.changed = _merge(universe, TimerWheel::NONE, loss.output);
+    }
+}
+
+}
@@ -0,0 +1,131 @@
+#ifndef UNIVERSE_MERGER_HPP
+#define UNIVERSE_MERGER_HPP
+
+#include "e131.h"
+#include "timer_wheel.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace gacn {
+
+enum MergeMode {
+    MERGE_LATEST, // most recent packet of the highest-priority sources wins
+    MERGE_HTP, // highest value per slot across the highest-priority sources
+};
+
+// Tracks every source (by CID) sending to a universe: sequence numbers,
+// priority, last data and last activity. Sources that terminate their stream
+// or stay silent for longer than the source timeout (the E1.31 network data
+// loss timeout by default) drop out of the merge.
+//
+// Liveness runs on a timer wheel with one timer per source x universe. A
+// packet only refreshes its source's last_seen; when the timer fires it is
+// re-armed from last_seen if the source is still alive, so the per-packet cost
+// does not depend on the number of sources being tracked.
+//
+// Not thread-safe; owned by one receive thread. Memory is only allocated when
+// a new universe or source shows up.
+class UniverseMerger {
+public:
+    static const uint64_t SOURCE_TIMEOUT_NS = 2500000000ull;
+
+    enum Result {
+        RESULT_DISCARDED, // out of sequence for its source
+        RESULT_DUPLICATE, // the source's last packet again, over another path
+        RESULT_IGNORED, // valid, but does not change the output (lower priority, non-DMX start code)
+        RESULT_MERGED, // output holds the new universe data
+    };
+
+    struct Output {
+        const uint8_t *data = nullptr;
+        uint16_t length = 0;
+    };
+
+    // Reported when a source stops sending to a universe.
+    struct Loss {
+        const uint8_t *cid = nullptr;
+        uint16_t universe = 0;
+        bool terminated = false; // stream terminated option rather than timeout
+        bool changed = false; // output holds the new merge of the remaining sources
+        bool universe_lost = false; // no sources left; output holds the last data
+        Output output;
+    };
+
+    UniverseMerger();
+
+    void set_mode(MergeMode p_mode);
+    MergeMode get_mode() const;
+    void set_source_timeout(uint64_t p_timeout_ns);
+    uint64_t get_source_timeout() const;
+
+    // on_loss(const Loss &) is called for sources removed by a terminated
+    // stream; the packet itself is then reported as RESULT_IGNORED.
+    template <typename F>
+    Result accept(const e131_packet_t &packet, uint64_t now_ns, Output &output, F &&on_loss);
+
+    // Removes sources whose timeout expired, calling on_loss for each.
+    template <typename F>
+    void expire(uint64_t now_ns, F &&on_loss);
+
+    void clear();
+    int get_source_count() const;
+
+private:
+    struct Source {
+        uint8_t cid[16];
+        uint16_t universe;
+        uint8_t priority;
+        uint8_t last_seq;
+        uint64_t last_seen;
+        uint16_t length;
+        uint8_t data[512];
+    };
+
+    struct Universe {
+        std::vector<uint32_t> sources; // indices into the source pool
+        uint16_t length = 0;
+        uint8_t merged[512];
+    };
+
+    MergeMode mode = MERGE_LATEST;
+    uint64_t source_timeout_ns = SOURCE_TIMEOUT_NS;
+    std::unordered_map<uint16_t, Universe> universes;
+    std::vector<Source> pool;
+    std::vector<uint32_t> free_sources;
+    TimerWheel wheel;
+
+    Result _accept(const e131_packet_t &packet, uint64_t now_ns, Output &output, Loss &loss, uint32_t &removed);
+    bool _expire_one(uint32_t id, uint64_t now_ns, Loss &loss);
+    void _remove(uint32_t id, bool terminated, Loss &loss);
+    bool _merge(Universe &universe, uint32_t preferred, Output &output);
+};
+
+template <typename F>
+UniverseMerger::Result UniverseMerger::accept(const e131_packet_t &packet, uint64_t now_ns, Output &output, F &&on_loss) {
+    Loss loss;
+    uint32_t removed = TimerWheel::NONE;
+    Result result = _accept(packet, now_ns, output, loss, removed);
+    if (removed != TimerWheel::NONE) {
+        on_loss(loss);
+        free_sources.push_back(removed);
+    }
+    return result;
+}
+
+template <typename F>
+void UniverseMerger::expire(uint64_t now_ns, F &&on_loss) {
+    wheel.advance(now_ns, [&](uint32_t id) {
+        Loss loss;
+        if (_expire_one(id, now_ns, loss)) {
+            on_loss(loss);
+            // The pool slot stays untouched until the callback is done with the CID.
+            free_sources.push_back(id);
+        }
+    });
+}
+
+}
+
+#endif